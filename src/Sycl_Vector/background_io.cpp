@@ -0,0 +1,106 @@
+#ifndef BACKGROUND_IO_CPP
+#define BACKGROUND_IO_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the background thread that runs checkpoint
+//         and restore jobs in the order they were submitted
+///////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <future>
+#include <functional>
+#include <condition_variable>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Background IO
+/// \brief    A single I/O thread with a job queue
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Runs jobs one after the other on its own thread, so a restore
+///        submitted after a checkpoint of the same file sees the finished
+///        file, and checkpoints never compete with each other for the disk
+
+class Background_IO_Thread{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Pending jobs, oldest first
+  std::deque<std::function<void()>> JOBS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Guards JOBS and STOP
+  std::mutex MUTEX;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Signals new jobs and shutdown to the worker
+  std::condition_variable WAKE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Set when the worker should exit once the queue is empty
+  bool STOP;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Worker thread
+  std::thread WORKER;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Queues f and returns a future for its result, exceptions
+    ///        thrown by f are rethrown by the future
+    template<typename Function_type>
+    auto submit(Function_type f) -> std::future<decltype(f())>{
+      using Result_type = decltype(f());
+      // std::function needs a copyable target
+      auto job = std::make_shared<std::packaged_task<Result_type()>>(std::move(f));
+      std::future<Result_type> result = job->get_future();
+      {
+        std::lock_guard<std::mutex> lock(MUTEX);
+        JOBS.emplace_back([job](){ (*job)(); });
+      }
+      WAKE.notify_one();
+      return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that starts the worker
+    Background_IO_Thread(): STOP(false){
+      WORKER = std::thread([this](){
+        std::unique_lock<std::mutex> lock(MUTEX);
+        while(true){
+          WAKE.wait(lock, [this](){ return STOP || !JOBS.empty(); });
+          if(JOBS.empty()){
+            return;
+          }
+          std::function<void()> job = std::move(JOBS.front());
+          JOBS.pop_front();
+          lock.unlock();
+          job();
+          lock.lock();
+        }
+      });
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Destructor that finishes the queued jobs before returning
+    ~Background_IO_Thread(){
+      {
+        std::lock_guard<std::mutex> lock(MUTEX);
+        STOP = true;
+      }
+      WAKE.notify_one();
+      WORKER.join();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the process wide I/O thread, started on first use
+inline Background_IO_Thread& background_io(){
+  static Background_IO_Thread thread;
+  return thread;
+}
+
+/// @}
+// end "Background IO" doxygen group
+
+#endif //#ifndef BACKGROUND_IO_CPP
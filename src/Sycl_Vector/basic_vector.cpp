@@ -7,8 +7,16 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <vector>
+#include <string>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <optional>
 #include <chrono>
 #include <thread>
+#include <limits>
 
 // Pybind11
 #include <pybind11/stl.h>
@@ -17,8 +25,56 @@
 // Sycl
 #include <CL/sycl.hpp>
 
+// Operation codes
+#include "vector_ops.cpp"
+
+// Shared storage
+#include "vector_storage.cpp"
+
+// Element-wise launches
+#include "kernel_ranges.cpp"
+
+// Prefix scans
+#include "scan_kernels.cpp"
+
+// Comparison predicates
+#include "vector_predicates.cpp"
+
+// Packed masks
+#include "bit_mask.cpp"
+
+// Polynomial evaluation
+#include "polynomials.cpp"
+
+// Random numbers
+#include "random_kernels.cpp"
+
+// Radix sort and select
+#include "radix_sort_kernels.cpp"
+#include "select_kernels.cpp"
+
+// Histograms
+#include "histogram_kernels.cpp"
+
+// Predicate queries
+#include "query_kernels.cpp"
+
+// Reductions
+#include "reduce_kernels.cpp"
+
+// Saving and loading
+#include "npy_format.cpp"
+#include "zip_format.cpp"
+#include "vector_io.cpp"
+#include "chunked_format.cpp"
+#include "text_format.cpp"
+
 namespace py = pybind11;
 
+class Sycl_Bit_Vector;
+class Sycl_Checkpoint;
+class Sycl_Restore;
+
 ///////////////////////////////////////////////////////////////////////////
 /// \defgroup Sycl Vector
 /// \brief    Creates a sycl based vector class
@@ -36,8 +92,53 @@ class Basic_Sycl_Vector{
   size_t SIZE;
 
   ////////////////////////////////////////////////////////////////////////
-  /// \brief Vector
-  std::vector<double> A;
+  /// \brief Vector, shared with the NumPy arrays returned by get_array
+  std::shared_ptr<double> A;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns the kernel time of an event in seconds when profiling
+  ///        is enabled
+  std::optional<double> kernel_time(sycl::event& kernel_event);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Gathers the elements whose flag is set into a new vector,
+  ///        together with their indices, without leaving the device
+  std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> compact_flagged(sycl::buffer<double>& A_buffer,
+                                                                      sycl::buffer<size_t>& flag_buffer);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Gathers the elements for which keep(value) is true into a new
+  ///        vector, together with their indices
+  template<typename Function_type>
+  std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> compact_if(Function_type keep);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns the elements with the given ascending ranks, found by
+  ///        radix select on the device
+  std::vector<double> select_ranks(const std::vector<size_t>& ranks);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Replaces each element v by f(v, u0, u1), where u0 and u1 are
+  ///        uniforms in [0, 1) drawn for the element index from the stream
+  ///        selected by seed
+  template<typename Function_type>
+  void apply_random(uint64_t seed, Function_type f);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Replaces each element i by f(i) without reading the vector
+  template<typename Function_type>
+  void generate(Function_type f);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns the counts of the vector in the given bins
+  py::array_t<int64_t> histogram_counts(const Histogram_Bins& bins, const std::vector<double>& edges);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Constructor that takes over existing storage of SIZE elements
+  Basic_Sycl_Vector(size_t SIZE_in, std::shared_ptr<double> storage):
+    SIZE(SIZE_in), A(std::move(storage)){}
+
+  friend class Sycl_Ragged_Vector;
 
   public:
     ////////////////////////////////////////////////////////////////////////
@@ -48,10 +149,37 @@ class Basic_Sycl_Vector{
     /// \brief Selects the gpu for the device
     void select_gpu_device();
 
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Enables or disables kernel profiling on the selected device
+    void enable_profiling(bool enable);
+
     ////////////////////////////////////////////////////////////////////////
     /// \brief Sets all vector elements to zero
     void reset();
 
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Sets all vector elements to value
+    void fill(double value);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Sets element i to start + i*step
+    void iota(double start, double step);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a vector with the values start, start + step, ...
+    ///        below stop (above stop for a negative step)
+    static Basic_Sycl_Vector arange(double start, double stop, double step);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a vector with num evenly spaced values from start to
+    ///        stop, stop is included when endpoint is set
+    static Basic_Sycl_Vector linspace(double start, double stop, size_t num, bool endpoint);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a vector with num values evenly spaced on a log scale
+    ///        from base^start to base^stop
+    static Basic_Sycl_Vector logspace(double start, double stop, size_t num, double base, bool endpoint);
+
     ////////////////////////////////////////////////////////////////////////
     /// \brief Adds some value x to each element
     template<typename Scalar_type>
@@ -72,17 +200,347 @@ class Basic_Sycl_Vector{
     template<typename Scalar_type>
     void divide_each_element(Scalar_type x);
 
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations (op codes paired with scalars)
+    ///        to each element in a single kernel, returns the kernel time
+    ///        in seconds when profiling is enabled
+    std::optional<double> apply_batch(const std::vector<int>& op_codes,
+                                      const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations written as an op string such
+    ///        as "+2 *3.5 /4" to each element in a single kernel
+    std::optional<double> apply_batch(const std::string& ops);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies the math function with code op (and scalar x for
+    ///        pow) to each element, in single precision with the native
+    ///        builtins when native is set
+    void apply_math(int op, double x, bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its exponential
+    void exp(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its natural logarithm
+    void log(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its square root
+    void sqrt(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Raises each element to the power p
+    void pow(double p, bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its sine
+    void sin(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its cosine
+    void cos(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its hyperbolic tangent
+    void tanh(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by its error function
+    void erf(bool native);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element v by v*a + b with a fused multiply-add
+    void fma(double a, double b);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element v[i] by v[i]*a[i] + b[i] with a fused
+    ///        multiply-add
+    void fma(const Basic_Sycl_Vector& a, const Basic_Sycl_Vector& b);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element by the polynomial with the given
+    ///        coefficients (highest degree first) evaluated at it
+    void polyval(const std::vector<double>& coefficients);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each element v in piece i (breaks[i] <= v <
+    ///        breaks[i + 1]) by the polynomial coefficients[i] evaluated at
+    ///        v - breaks[i], elements outside the breaks use the first or
+    ///        last piece
+    void ppval(const std::vector<double>& breaks,
+               const std::vector<std::vector<double>>& coefficients);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Fills the vector with uniform samples in [lo, hi)
+    void fill_uniform(double lo, double hi, uint64_t seed);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Fills the vector with normal samples
+    void fill_normal(double mean, double stddev, uint64_t seed);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Fills the vector with exponential samples of the given rate
+    void fill_exponential(double rate, uint64_t seed);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds uniform noise in [lo, hi) to each element
+    void add_uniform_noise(double lo, double hi, uint64_t seed);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds zero mean normal noise to each element
+    void add_normal_noise(double stddev, uint64_t seed);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds x[k] to each element of block k, where element i
+    ///        belongs to block (i/block_size) % x.size()
+    void add_each_block(const std::vector<double>& x, size_t block_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Subtracts x[k] from each element of block k
+    void subtract_each_block(const std::vector<double>& x, size_t block_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Multiplies each element of block k by x[k]
+    void multiply_each_block(const std::vector<double>& x, size_t block_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Divides each element of block k by x[k]
+    void divide_each_block(const std::vector<double>& x, size_t block_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations in a single kernel, where
+    ///        operation j uses the scalar x[j][k] on the elements of
+    ///        block k, returns the kernel time in seconds when profiling
+    ///        is enabled
+    std::optional<double> apply_batch_each_block(const std::vector<int>& op_codes,
+                                                 const std::vector<std::vector<double>>& x,
+                                                 size_t block_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations in a single kernel to the
+    ///        elements whose bit is set in a packed mask, the other
+    ///        elements keep their value, returns the kernel time in seconds
+    ///        when profiling is enabled
+    std::optional<double> apply_batch_masked(const std::vector<int>& op_codes,
+                                             const std::vector<double>& x,
+                                             py::array_t<uint64_t, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds some value x to each element whose mask bit is set
+    void add_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Subtracts some value x from each element whose mask bit is set
+    void subtract_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Multiplies each element whose mask bit is set by some value x
+    void multiply_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Divides each element whose mask bit is set by some value x
+    void divide_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Limits each element to [lo, hi], NaNs are kept
+    void clip(double lo, double hi);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a new vector that takes element i from a where bit i
+    ///        of a packed mask is set and from b otherwise
+    static Basic_Sycl_Vector where(py::array_t<uint64_t, py::array::c_style> mask,
+                                   const Basic_Sycl_Vector& a, const Basic_Sycl_Vector& b);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces the vector by its inclusive or exclusive scan with
+    ///        op and its identity, op must be one of the sycl group
+    ///        function objects plus, multiplies, minimum or maximum,
+    ///        which are the ones with_scan_op selects
+    template<typename Op_type>
+    void scan(double identity, Op_type op, bool inclusive);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces the vector by its inclusive scan with the operation
+    ///        op ("sum", "prod", "min" or "max")
+    void inclusive_scan(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces the vector by its exclusive scan with the operation
+    ///        op ("sum", "prod", "min" or "max")
+    void exclusive_scan(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the inclusive scan of the vector as a new vector
+    Basic_Sycl_Vector inclusive_scan_copy(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the exclusive scan of the vector as a new vector
+    Basic_Sycl_Vector exclusive_scan_copy(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the elements that satisfy the comparison op with the
+    ///        thresholds x and y as a new vector, together with their indices
+    std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> filter(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the finite elements as a new vector, together with
+    ///        their indices
+    std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> remove_nonfinite();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the elements where mask is true as a new vector,
+    ///        together with their indices
+    std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> compact(py::array_t<bool, py::array::c_style> mask);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a packed bit vector that is set where the element
+    ///        satisfies the comparison
+    Sycl_Bit_Vector compare(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns true when an element satisfies the comparison,
+    ///        stopping at the first hit
+    bool any(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns true when every element satisfies the comparison,
+    ///        stopping at the first miss
+    bool all(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of elements that satisfy the comparison
+    size_t count_if(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the index of the first element that satisfies the
+    ///        comparison, or -1 when there is none
+    int64_t find_first(const std::string& op, double x, double y);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of the elements
+    double sum();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of the elements
+    double min();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of the elements
+    double max();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Sorts the vector in ascending order, NaNs go last
+    void sort();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the indices that sort the vector in ascending order,
+    ///        equal elements keep their original order
+    py::array_t<int64_t> argsort();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the element that would be at index k if the vector
+    ///        was sorted, without sorting it
+    double kth_element(size_t k);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the k largest elements in descending order together
+    ///        with their indices, without sorting the vector
+    std::pair<py::array_t<double>, py::array_t<int64_t>> top_k(size_t k);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the median of the vector
+    double median();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the quantiles q (between 0 and 1) of the vector, with
+    ///        linear interpolation between neighbouring elements
+    std::vector<double> quantiles(const std::vector<double>& q);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the counts in N_BINS equal width bins over [lo, hi]
+    py::array_t<int64_t> histogram(size_t N_BINS, double lo, double hi);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the counts in N_BINS bins of equal width in log space
+    ///        over [lo, hi], with 0 < lo
+    py::array_t<int64_t> histogram_log(size_t N_BINS, double lo, double hi);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the counts in the bins between consecutive edges
+    py::array_t<int64_t> histogram_edges(const std::vector<double>& edges);
+
     ////////////////////////////////////////////////////////////////////////
     /// \brief Returns the vector
     std::vector<double> get_vector();
 
     ////////////////////////////////////////////////////////////////////////
-    /// \brief Constructor that initializes the vector
-    Basic_Sycl_Vector(int SIZE_in): SIZE(SIZE_in){
-      for(int i = 0; i < SIZE; ++i){
-        A.push_back(0.0);
-      }
-    }
+    /// \brief Returns a NumPy array that shares the vector storage
+    py::array_t<double> get_array();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Saves the vector as a .npy file, or as a .npz archive when
+    ///        path ends in .npz, with one pwrite stream per thread and
+    ///        O_DIRECT for the bulk of the data when direct is set
+    void save(const std::string& path, bool direct);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Loads a vector from a .npy file or from the member key (the
+    ///        first member when empty) of a .npz archive, either mapping
+    ///        the file copy-on-write or reading it with one pread stream
+    ///        per thread
+    static Basic_Sycl_Vector load(const std::string& path, bool mmap, bool direct, const std::string& key);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Saves the vector in the chunked format with chunks of
+    ///        chunk_size elements coded by codec, in parallel
+    void save_compressed(const std::string& path, const std::string& codec, size_t chunk_size);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Loads the elements [begin, end) of a vector saved with
+    ///        save_compressed, decoding only the chunks of the range
+    static Basic_Sycl_Vector load_compressed(const std::string& path, size_t begin, size_t end);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Loads the numbers of a delimited or whitespace separated text
+    ///        file in row major order, parsing segments of the mapped file
+    ///        in parallel straight into the vector
+    static Basic_Sycl_Vector load_text(const std::string& path, const std::string& delimiter, size_t skip_rows,
+                                       const std::string& comments);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Copies the vector and writes the copy to path on the
+    ///        background I/O thread, as .npy (or .npz) without a codec or in
+    ///        the chunked format with one, returns at once
+    Sycl_Checkpoint checkpoint(const std::string& path, const std::string& codec);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Loads a checkpoint on the background I/O thread, returns at
+    ///        once
+    static Sycl_Restore restore(const std::string& path);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that initializes the vector, large vectors are
+    ///        first touched in parallel and can ask for transparent huge
+    ///        pages
+    Basic_Sycl_Vector(size_t SIZE_in, bool huge_pages = false):
+      SIZE(SIZE_in), A(allocate_storage<double>(SIZE, huge_pages)){}
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that adopts the memory of a NumPy array without
+    ///        copying
+    Basic_Sycl_Vector(py::array_t<double, py::array::c_style> values):
+      SIZE(values.size()), A(adopt_storage(values)){}
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Copy constructor that copies the vector storage, in parallel
+    ///        for large vectors
+    Basic_Sycl_Vector(const Basic_Sycl_Vector& other):
+      Q(other.Q), SIZE(other.SIZE), A(allocate_storage<double>(other.SIZE, false, other.A.get())){}
+
+    Basic_Sycl_Vector(Basic_Sycl_Vector&&) = default;
+    Basic_Sycl_Vector& operator=(Basic_Sycl_Vector&&) = default;
 };
 
 /// @}
@@ -103,39 +561,96 @@ void Basic_Sycl_Vector::select_gpu_device(){
 }
 
 ////////////////////////////////////////////////////////////////////////
-void Basic_Sycl_Vector::reset(){
+void Basic_Sycl_Vector::enable_profiling(bool enable){
+  set_queue_profiling(Q, enable);
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Function_type>
+void Basic_Sycl_Vector::generate(Function_type f){
   // creating a sycl scope
   {
     // creating a buffer for the vector
-    sycl::buffer<double> A_buffer{A};
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
 
-    // executing a sycl kernel
+    // executing a sycl kernel, the old values are never copied to the device
     Q.submit([&](sycl::handler &h){
       // creating a device accessor
-      sycl::accessor A_access{A_buffer, h};
-      h.parallel_for<Basic_Sycl_Vector>(SIZE, [=](sycl::id<1> idx){
-        const int i = 0;
-        A[i] = 0.0;
+      sycl::accessor A_access{A_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] = f(idx);
       });
     });
   }
 }
 
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::reset(){
+  fill(0.0);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fill(double value){
+  generate([=](size_t){ return value; });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::iota(double start, double step){
+  generate([=](size_t i){ return sycl::fma(static_cast<double>(i), step, start); });
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::arange(double start, double stop, double step){
+  if(step == 0.0 || !std::isfinite(step) || !std::isfinite(start) || !std::isfinite(stop)){
+    throw std::invalid_argument("arange needs finite bounds and a finite, non-zero step");
+  }
+  const double count = std::ceil((stop - start)/step);
+  Basic_Sycl_Vector result(count > 0.0 ? static_cast<size_t>(count) : 0);
+  result.iota(start, step);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::linspace(double start, double stop, size_t num, bool endpoint){
+  Basic_Sycl_Vector result(num);
+  const size_t divisions = endpoint ? num - 1 : num;
+  const double step = divisions > 0 ? (stop - start)/static_cast<double>(divisions) : 0.0;
+  const size_t last = num > 1 ? num - 1 : num;
+
+  // the last value is stop exactly, as in numpy.linspace
+  result.generate([=](size_t i){
+    return endpoint && i == last ? stop : sycl::fma(static_cast<double>(i), step, start);
+  });
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::logspace(double start, double stop, size_t num, double base, bool endpoint){
+  Basic_Sycl_Vector result(num);
+  const size_t divisions = endpoint ? num - 1 : num;
+  const double step = divisions > 0 ? (stop - start)/static_cast<double>(divisions) : 0.0;
+  const size_t last = num > 1 ? num - 1 : num;
+
+  result.generate([=](size_t i){
+    return sycl::pow(base, endpoint && i == last ? stop : sycl::fma(static_cast<double>(i), step, start));
+  });
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////
 template<typename Scalar_type>
 void Basic_Sycl_Vector::add_each_element(Scalar_type x){
   // creating a sycl scope
   {
     // creating a buffer for the vector
-    sycl::buffer<double> A_buffer{A};
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
 
     // executing a sycl kernel
     Q.submit([&](sycl::handler &h){
       // creating a device accessor
       sycl::accessor A_access{A_buffer, h};
-      h.parallel_for<Basic_Sycl_Vector>(SIZE, [=](sycl::id<1> idx){
-        const int i = 0;
-        A_access[i] += x;
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] += x;
       });
     });
   }
@@ -147,15 +662,14 @@ void Basic_Sycl_Vector::subtract_each_element(Scalar_type x){
   // creating a sycl scope
   {
     // creating a buffer for the vector
-    sycl::buffer<double> A_buffer{A};
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
 
     // executing a sycl kernel
     Q.submit([&](sycl::handler &h){
       // creating a device accessor
       sycl::accessor A_access{A_buffer, h};
-      h.parallel_for<Basic_Sycl_Vector>(SIZE, [=](sycl::id<1> idx){
-        const int i = 0;
-        A_access[i] -= x;
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] -= x;
       });
     });
   }
@@ -167,15 +681,14 @@ void Basic_Sycl_Vector::multiply_each_element(Scalar_type x){
   // creating a sycl scope
   {
     // creating a buffer for the vector
-    sycl::buffer<double> A_buffer{A};
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
 
     // executing a sycl kernel
     Q.submit([&](sycl::handler &h){
       // creating a device accessor
       sycl::accessor A_access{A_buffer, h};
-      h.parallel_for<Basic_Sycl_Vector>(SIZE, [=](sycl::id<1> idx){
-        const int i = 0;
-        A_access[i] *= x;
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] *= x;
       });
     });
   }
@@ -187,60 +700,1256 @@ void Basic_Sycl_Vector::divide_each_element(Scalar_type x){
   // creating a sycl scope
   {
     // creating a buffer for the vector
-    sycl::buffer<double> A_buffer{A};
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
 
     // executing a sycl kernel
     Q.submit([&](sycl::handler &h){
       // creating a device accessor
       sycl::accessor A_access{A_buffer, h};
-      h.parallel_for<Basic_Sycl_Vector>(SIZE, [=](sycl::id<1> idx){
-        const int i = 0;
-        A_access[i] /= x;
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] /= x;
       });
     });
   }
 }
 
 ////////////////////////////////////////////////////////////////////////
-std::vector<double> Basic_Sycl_Vector::get_vector(){
-  return A;
+std::optional<double> Basic_Sycl_Vector::apply_batch(const std::vector<int>& op_codes,
+                                                     const std::vector<double>& x){
+  check_vector_ops(op_codes, x);
+
+  if(op_codes.empty() || SIZE == 0){
+    return std::nullopt;
+  }
+
+  const size_t N_OPS = op_codes.size();
+  sycl::event kernel_event;
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the op chain
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<int> op_buffer{op_codes.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<double> x_buffer{x.data(), sycl::range<1>{N_OPS}};
+
+    // executing a single sycl kernel for the whole chain
+    kernel_event = Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor op_access{op_buffer, h, sycl::read_only};
+      sycl::accessor x_access{x_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        double value = A_access[idx];
+        for(size_t k = 0; k < N_OPS; ++k){
+          value = apply_vector_op(op_access[k], value, x_access[k]);
+        }
+        A_access[idx] = value;
+      });
+    });
+  }
+
+  return kernel_time(kernel_event);
 }
 
-#endif //#ifndef BASIC_VECTOR_CPP
+////////////////////////////////////////////////////////////////////////
+std::optional<double> Basic_Sycl_Vector::apply_batch(const std::string& ops){
+  std::vector<int> op_codes;
+  std::vector<double> x;
+  parse_vector_ops(ops, op_codes, x);
+  return apply_batch(op_codes, x);
+}
 
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::apply_math(int op, double x, bool native){
+  apply_batch({native ? (op | VECTOR_OP_NATIVE) : op}, {x});
+}
 
-PYBIND11_MODULE(sycl_vector, m){
-  m.doc() = R"myDelim(
-    User guide documentation for the 'Basic Sycl Vector' module.
-    ------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::exp(bool native){
+  apply_math(VECTOR_OP_EXP, 0.0, native);
+}
 
-    .. currentmodule:: basic sycl vector
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::log(bool native){
+  apply_math(VECTOR_OP_LOG, 0.0, native);
+}
 
-    .. autosummary::
-      :toctree: _generate
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::sqrt(bool native){
+  apply_math(VECTOR_OP_SQRT, 0.0, native);
+}
 
-      print_device
-      select_gpu_device
-      reset
-      add_each_element
-      subtract_each_element
-      multiply_each_element
-      divide_each_element
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::pow(double p, bool native){
+  apply_math(VECTOR_OP_POW, p, native);
+}
 
-  )myDelim";
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::sin(bool native){
+  apply_math(VECTOR_OP_SIN, 0.0, native);
+}
 
-  py::class_<Basic_Sycl_Vector>(m, "basic_sycl_vector").def(py::init<int>(), R"myDelim(
-    Initialize a basic sycl vector with some input size 'SIZE'
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::cos(bool native){
+  apply_math(VECTOR_OP_COS, 0.0, native);
+}
 
-    Parameters
-    ----------
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::tanh(bool native){
+  apply_math(VECTOR_OP_TANH, 0.0, native);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::erf(bool native){
+  apply_math(VECTOR_OP_ERF, 0.0, native);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fma(double a, double b){
+  // creating a sycl scope
+  {
+    // creating a buffer for the vector
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel
+    Q.submit([&](sycl::handler &h){
+      // creating a device accessor
+      sycl::accessor A_access{A_buffer, h};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] = sycl::fma(A_access[idx], a, b);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fma(const Basic_Sycl_Vector& a, const Basic_Sycl_Vector& b){
+  if(a.SIZE != SIZE || b.SIZE != SIZE){
+    throw std::invalid_argument("vector sizes differ");
+  }
+
+  // v.fma(v, w), v.fma(w, v) and v.fma(w, w) share storage between the
+  // operands, which get one buffer and accessor since sycl does not allow
+  // two buffers over the same host memory
+  const bool A_IS_THIS = a.A == A;
+  const bool B_IS_THIS = b.A == A;
+  const bool B_IS_A    = b.A == a.A;
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the distinct operands
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    std::optional<sycl::buffer<double>> a_buffer;
+    std::optional<sycl::buffer<double>> b_buffer;
+    if(!A_IS_THIS){
+      a_buffer.emplace(a.A.get(), sycl::range<1>{SIZE});
+    }
+    if(!B_IS_THIS && !B_IS_A){
+      b_buffer.emplace(b.A.get(), sycl::range<1>{SIZE});
+    }
+
+    // executing a sycl kernel
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      if(A_IS_THIS && B_IS_THIS){
+        parallel_for_each(h, SIZE, [=](size_t idx){
+          const double value = A_access[idx];
+          A_access[idx] = sycl::fma(value, value, value);
+        });
+      }
+      else if(A_IS_THIS){
+        sycl::accessor b_access{*b_buffer, h, sycl::read_only};
+        parallel_for_each(h, SIZE, [=](size_t idx){
+          const double value = A_access[idx];
+          A_access[idx] = sycl::fma(value, value, b_access[idx]);
+        });
+      }
+      else if(B_IS_THIS){
+        sycl::accessor a_access{*a_buffer, h, sycl::read_only};
+        parallel_for_each(h, SIZE, [=](size_t idx){
+          const double value = A_access[idx];
+          A_access[idx] = sycl::fma(value, a_access[idx], value);
+        });
+      }
+      else if(B_IS_A){
+        sycl::accessor a_access{*a_buffer, h, sycl::read_only};
+        parallel_for_each(h, SIZE, [=](size_t idx){
+          const double x = a_access[idx];
+          A_access[idx] = sycl::fma(A_access[idx], x, x);
+        });
+      }
+      else{
+        sycl::accessor a_access{*a_buffer, h, sycl::read_only};
+        sycl::accessor b_access{*b_buffer, h, sycl::read_only};
+        parallel_for_each(h, SIZE, [=](size_t idx){
+          A_access[idx] = sycl::fma(A_access[idx], a_access[idx], b_access[idx]);
+        });
+      }
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::polyval(const std::vector<double>& coefficients){
+  const size_t N_COEFFICIENTS = coefficients.size();
+  if(N_COEFFICIENTS == 0){
+    reset();
+    return;
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the coefficients
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<double> c_buffer{coefficients.data(), sycl::range<1>{N_COEFFICIENTS}};
+
+    // executing a single sycl kernel for every degree
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor c_access{c_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] = horner(c_access, 0, N_COEFFICIENTS, A_access[idx]);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::ppval(const std::vector<double>& breaks,
+                              const std::vector<std::vector<double>>& coefficients){
+  const size_t N_COEFFICIENTS = check_piecewise_polynomial(breaks, coefficients);
+  const size_t N_PIECES = coefficients.size();
+
+  // flattening the coefficients so that piece i starts at i*N_COEFFICIENTS
+  std::vector<double> c_flat;
+  c_flat.reserve(N_PIECES*N_COEFFICIENTS);
+  for(const auto& piece : coefficients){
+    c_flat.insert(c_flat.end(), piece.begin(), piece.end());
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector, the breaks and the coefficients
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<double> break_buffer{breaks.data(), sycl::range<1>{breaks.size()}};
+    sycl::buffer<double> c_buffer{c_flat.data(), sycl::range<1>{c_flat.size()}};
+
+    // executing a sycl kernel that finds each piece and evaluates it
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor break_access{break_buffer, h, sycl::read_only};
+      sycl::accessor c_access{c_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        const double value = A_access[idx];
+        const size_t piece = find_piece(break_access, N_PIECES, value);
+        A_access[idx] = horner(c_access, piece*N_COEFFICIENTS, N_COEFFICIENTS,
+                               value - break_access[piece]);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Function_type>
+void Basic_Sycl_Vector::apply_random(uint64_t seed, Function_type f){
+  // creating a sycl scope
+  {
+    // creating a buffer for the vector
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel where each element draws from its own counter
+    Q.submit([&](sycl::handler &h){
+      // creating a device accessor
+      sycl::accessor A_access{A_buffer, h};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        double u0, u1;
+        philox_uniform2(seed, idx, u0, u1);
+        A_access[idx] = f(A_access[idx], u0, u1);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fill_uniform(double lo, double hi, uint64_t seed){
+  apply_random(seed, [=](double, double u0, double){ return lo + (hi - lo)*u0; });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fill_normal(double mean, double stddev, uint64_t seed){
+  apply_random(seed, [=](double, double u0, double u1){
+    return sycl::fma(stddev, normal_from_uniform2(u0, u1), mean);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::fill_exponential(double rate, uint64_t seed){
+  if(!(rate > 0.0)){
+    throw std::invalid_argument("rate must be positive");
+  }
+  apply_random(seed, [=](double, double u0, double){ return -sycl::log(1.0 - u0)/rate; });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::add_uniform_noise(double lo, double hi, uint64_t seed){
+  apply_random(seed, [=](double value, double u0, double){ return value + lo + (hi - lo)*u0; });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::add_normal_noise(double stddev, uint64_t seed){
+  apply_random(seed, [=](double value, double u0, double u1){
+    return sycl::fma(stddev, normal_from_uniform2(u0, u1), value);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::add_each_block(const std::vector<double>& x, size_t block_size){
+  apply_batch_each_block({VECTOR_OP_ADD}, {x}, block_size);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::subtract_each_block(const std::vector<double>& x, size_t block_size){
+  apply_batch_each_block({VECTOR_OP_SUBTRACT}, {x}, block_size);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::multiply_each_block(const std::vector<double>& x, size_t block_size){
+  apply_batch_each_block({VECTOR_OP_MULTIPLY}, {x}, block_size);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::divide_each_block(const std::vector<double>& x, size_t block_size){
+  apply_batch_each_block({VECTOR_OP_DIVIDE}, {x}, block_size);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::optional<double> Basic_Sycl_Vector::apply_batch_each_block(const std::vector<int>& op_codes,
+                                                                const std::vector<std::vector<double>>& x,
+                                                                size_t block_size){
+  if(op_codes.size() != x.size()){
+    throw std::invalid_argument("number of op codes and scalar vectors differ");
+  }
+  if(block_size == 0){
+    throw std::invalid_argument("block size must be positive");
+  }
+
+  const size_t N_OPS = op_codes.size();
+  const size_t N_BLOCKS = N_OPS == 0 ? 0 : x[0].size();
+
+  // flattening the scalars so that op j uses x_flat[j*N_BLOCKS + k]
+  std::vector<double> x_flat;
+  x_flat.reserve(N_OPS*N_BLOCKS);
+  for(const auto& x_op : x){
+    if(x_op.size() != N_BLOCKS || N_BLOCKS == 0){
+      throw std::invalid_argument("each op needs the same, non-zero number of scalars");
+    }
+    x_flat.insert(x_flat.end(), x_op.begin(), x_op.end());
+  }
+  check_vector_op_codes(op_codes);
+
+  if(N_OPS == 0 || SIZE == 0){
+    return std::nullopt;
+  }
+
+  sycl::event kernel_event;
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the op chain
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<int> op_buffer{op_codes.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<double> x_buffer{x_flat.data(), sycl::range<1>{x_flat.size()}};
+
+    // executing a single sycl kernel for the whole chain
+    kernel_event = Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor op_access{op_buffer, h, sycl::read_only};
+      sycl::accessor x_access{x_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        const size_t block = (idx/block_size) % N_BLOCKS;
+        double value = A_access[idx];
+        for(size_t j = 0; j < N_OPS; ++j){
+          value = apply_vector_op(op_access[j], value, x_access[j*N_BLOCKS + block]);
+        }
+        A_access[idx] = value;
+      });
+    });
+  }
+
+  return kernel_time(kernel_event);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::optional<double> Basic_Sycl_Vector::apply_batch_masked(const std::vector<int>& op_codes,
+                                                            const std::vector<double>& x,
+                                                            py::array_t<uint64_t, py::array::c_style> mask){
+  check_vector_ops(op_codes, x);
+  check_mask_words(mask.size(), SIZE);
+
+  if(op_codes.empty() || SIZE == 0){
+    return std::nullopt;
+  }
+
+  const size_t N_OPS = op_codes.size();
+  sycl::event kernel_event;
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector, the op chain and the mask
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<int> op_buffer{op_codes.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<double> x_buffer{x.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<uint64_t> mask_buffer{mask.data(), sycl::range<1>{mask_words(SIZE)}};
+
+    // executing a single sycl kernel for the whole chain, the result is
+    // selected rather than branched on so every work-item does the same work
+    kernel_event = Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor op_access{op_buffer, h, sycl::read_only};
+      sycl::accessor x_access{x_buffer, h, sycl::read_only};
+      sycl::accessor mask_access{mask_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        const double value = A_access[idx];
+        double result = value;
+        for(size_t k = 0; k < N_OPS; ++k){
+          result = apply_vector_op(op_access[k], result, x_access[k]);
+        }
+        A_access[idx] = mask_bit(mask_access, idx) ? result : value;
+      });
+    });
+  }
+
+  return kernel_time(kernel_event);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::add_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask){
+  apply_batch_masked({VECTOR_OP_ADD}, {x}, mask);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::subtract_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask){
+  apply_batch_masked({VECTOR_OP_SUBTRACT}, {x}, mask);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::multiply_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask){
+  apply_batch_masked({VECTOR_OP_MULTIPLY}, {x}, mask);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::divide_each_element_masked(double x, py::array_t<uint64_t, py::array::c_style> mask){
+  apply_batch_masked({VECTOR_OP_DIVIDE}, {x}, mask);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::clip(double lo, double hi){
+  if(!(lo <= hi)){
+    throw std::invalid_argument("clip needs lo <= hi");
+  }
+
+  // creating a sycl scope
+  {
+    // creating a buffer for the vector
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel
+    Q.submit([&](sycl::handler &h){
+      // creating a device accessor
+      sycl::accessor A_access{A_buffer, h};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        const double value = A_access[idx];
+        A_access[idx] = value < lo ? lo : (value > hi ? hi : value);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::where(py::array_t<uint64_t, py::array::c_style> mask,
+                                           const Basic_Sycl_Vector& a, const Basic_Sycl_Vector& b){
+  if(a.SIZE != b.SIZE){
+    throw std::invalid_argument("vector sizes differ");
+  }
+  check_mask_words(mask.size(), a.SIZE);
+
+  const size_t SIZE = a.SIZE;
+  Basic_Sycl_Vector result(SIZE);
+  result.Q = a.Q;
+
+  if(SIZE > 0){
+    // creating buffers for the inputs, the mask and the result
+    sycl::buffer<double> a_buffer{a.A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<double> b_buffer{b.A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> mask_buffer{mask.data(), sycl::range<1>{mask_words(SIZE)}};
+    sycl::buffer<double> result_buffer{result.A.get(), sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel that selects between the inputs
+    result.Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor a_access{a_buffer, h, sycl::read_only};
+      sycl::accessor b_access{b_buffer, h, sycl::read_only};
+      sycl::accessor mask_access{mask_buffer, h, sycl::read_only};
+      sycl::accessor result_access{result_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        result_access[idx] = mask_bit(mask_access, idx) ? a_access[idx] : b_access[idx];
+      });
+    });
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Op_type>
+void Basic_Sycl_Vector::scan(double identity, Op_type op, bool inclusive){
+  // creating a sycl scope
+  {
+    // creating a buffer for the vector
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+
+    // executing the multi-level scan on the device
+    scan_buffer(Q, A_buffer, SIZE, identity, op, inclusive);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::inclusive_scan(const std::string& op){
+  with_scan_op(op, [&](double identity, auto scan_op){
+    scan(identity, scan_op, true);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::exclusive_scan(const std::string& op){
+  with_scan_op(op, [&](double identity, auto scan_op){
+    scan(identity, scan_op, false);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::inclusive_scan_copy(const std::string& op){
+  Basic_Sycl_Vector result(*this);
+  result.inclusive_scan(op);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::exclusive_scan_copy(const std::string& op){
+  Basic_Sycl_Vector result(*this);
+  result.exclusive_scan(op);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> Basic_Sycl_Vector::filter(const std::string& op,
+                                                                              double x, double y){
+  return compact_if(make_vector_predicate(op, x, y));
+}
+
+////////////////////////////////////////////////////////////////////////
+std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> Basic_Sycl_Vector::remove_nonfinite(){
+  return filter("finite", 0.0, 0.0);
+}
+
+////////////////////////////////////////////////////////////////////////
+bool Basic_Sycl_Vector::any(const std::string& op, double x, double y){
+  return find_first(op, x, y) >= 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+bool Basic_Sycl_Vector::all(const std::string& op, double x, double y){
+  const Vector_Predicate predicate = make_vector_predicate(op, x, y);
+
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    return find_first_buffer(Q, A_buffer, SIZE, [=](double value){ return !predicate(value); }) == SIZE;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Basic_Sycl_Vector::count_if(const std::string& op, double x, double y){
+  const Vector_Predicate predicate = make_vector_predicate(op, x, y);
+
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    return count_if_buffer(Q, A_buffer, SIZE, predicate);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+int64_t Basic_Sycl_Vector::find_first(const std::string& op, double x, double y){
+  const Vector_Predicate predicate = make_vector_predicate(op, x, y);
+
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    const size_t first = find_first_buffer(Q, A_buffer, SIZE, predicate);
+    return first < SIZE ? static_cast<int64_t>(first) : -1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+double Basic_Sycl_Vector::sum(){
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    return reduce_buffer(Q, A_buffer, SIZE, 0.0, sycl::plus<double>());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+double Basic_Sycl_Vector::min(){
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    return reduce_buffer(Q, A_buffer, SIZE, std::numeric_limits<double>::infinity(), sycl::minimum<double>());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+double Basic_Sycl_Vector::max(){
+  // creating a sycl scope
+  {
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    return reduce_buffer(Q, A_buffer, SIZE, -std::numeric_limits<double>::infinity(), sycl::maximum<double>());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> Basic_Sycl_Vector::compact(py::array_t<bool, py::array::c_style> mask){
+  if(static_cast<size_t>(mask.size()) != SIZE){
+    throw std::invalid_argument("mask size differs from vector size");
+  }
+
+  if(SIZE == 0){
+    return {Basic_Sycl_Vector(0), share_storage(allocate_storage<int64_t>(0), 0)};
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector, the mask and the survivor flags
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<bool> mask_buffer{mask.data(), sycl::range<1>{SIZE}};
+    sycl::buffer<size_t> flag_buffer{sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel that flags the survivors
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor mask_access{mask_buffer, h, sycl::read_only};
+      sycl::accessor flag_access{flag_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        flag_access[idx] = mask_access[idx] ? 1 : 0;
+      });
+    });
+
+    return compact_flagged(A_buffer, flag_buffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Function_type>
+std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> Basic_Sycl_Vector::compact_if(Function_type keep){
+  if(SIZE == 0){
+    return {Basic_Sycl_Vector(0), share_storage(allocate_storage<int64_t>(0), 0)};
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the survivor flags
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<size_t> flag_buffer{sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel that flags the survivors
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor flag_access{flag_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        flag_access[idx] = keep(A_access[idx]) ? 1 : 0;
+      });
+    });
+
+    return compact_flagged(A_buffer, flag_buffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+std::pair<Basic_Sycl_Vector, py::array_t<int64_t>> Basic_Sycl_Vector::compact_flagged(sycl::buffer<double>& A_buffer,
+                                                                                       sycl::buffer<size_t>& flag_buffer){
+  // scanning the flags into output positions
+  sycl::buffer<size_t> position_buffer{sycl::range<1>{SIZE}};
+  Q.submit([&](sycl::handler &h){
+    sycl::accessor flag_access{flag_buffer, h, sycl::read_only};
+    sycl::accessor position_access{position_buffer, h, sycl::write_only, sycl::no_init};
+    h.copy(flag_access, position_access);
+  });
+  scan_buffer(Q, position_buffer, SIZE, size_t(0), sycl::plus<size_t>(), false);
+
+  // counting the survivors on the device so only one value is read back
+  sycl::buffer<size_t> count_buffer{sycl::range<1>{1}};
+  Q.submit([&](sycl::handler &h){
+    sycl::accessor flag_access{flag_buffer, h, sycl::read_only};
+    sycl::accessor position_access{position_buffer, h, sycl::read_only};
+    sycl::accessor count_access{count_buffer, h, sycl::write_only, sycl::no_init};
+    const size_t last = SIZE - 1;
+    h.single_task([=](){
+      count_access[0] = position_access[last] + flag_access[last];
+    });
+  });
+  const size_t count = sycl::host_accessor{count_buffer, sycl::read_only}[0];
+
+  Basic_Sycl_Vector result(count);
+  result.Q = Q;
+  std::shared_ptr<int64_t> indices = allocate_storage<int64_t>(count);
+
+  if(count > 0){
+    // creating buffers for the survivors and their indices
+    sycl::buffer<double> result_buffer{result.A.get(), sycl::range<1>{count}};
+    sycl::buffer<int64_t> index_buffer{indices.get(), sycl::range<1>{count}};
+
+    // executing a sycl kernel that scatters the survivors
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor flag_access{flag_buffer, h, sycl::read_only};
+      sycl::accessor position_access{position_buffer, h, sycl::read_only};
+      sycl::accessor result_access{result_buffer, h, sycl::write_only, sycl::no_init};
+      sycl::accessor index_access{index_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        if(flag_access[idx]){
+          const size_t position = position_access[idx];
+          result_access[position] = A_access[idx];
+          index_access[position] = static_cast<int64_t>(idx);
+        }
+      });
+    });
+  }
+
+  return {std::move(result), share_storage(indices, count)};
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::sort(){
+  if(SIZE < 2){
+    return;
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the sort keys
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> key_buffer{sycl::range<1>{SIZE}};
+    sycl::buffer<int64_t> index_buffer{sycl::range<1>{1}};
+
+    // executing a sycl kernel that maps the elements to ordered keys
+    Q.submit([&](sycl::handler &h){
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor key_access{key_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        key_access[idx] = radix_key_from_double(A_access[idx]);
+      });
+    });
+
+    radix_sort_buffer<false>(Q, key_buffer, index_buffer, SIZE);
+
+    // executing a sycl kernel that maps the sorted keys back
+    Q.submit([&](sycl::handler &h){
+      sycl::accessor key_access{key_buffer, h, sycl::read_only};
+      sycl::accessor A_access{A_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        A_access[idx] = double_from_radix_key(key_access[idx]);
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Basic_Sycl_Vector::argsort(){
+  std::shared_ptr<int64_t> indices = allocate_storage<int64_t>(SIZE);
+
+  if(SIZE > 0){
+    // creating buffers for the vector, the sort keys and the indices
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> key_buffer{sycl::range<1>{SIZE}};
+    sycl::buffer<int64_t> index_buffer{indices.get(), sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel that maps the elements to ordered keys
+    Q.submit([&](sycl::handler &h){
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor key_access{key_buffer, h, sycl::write_only, sycl::no_init};
+      sycl::accessor index_access{index_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        key_access[idx] = radix_key_from_double(A_access[idx]);
+        index_access[idx] = static_cast<int64_t>(idx);
+      });
+    });
+
+    radix_sort_buffer<true>(Q, key_buffer, index_buffer, SIZE);
+  }
+
+  return share_storage(indices, SIZE);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Basic_Sycl_Vector::select_ranks(const std::vector<size_t>& ranks){
+  std::vector<double> result;
+  result.reserve(ranks.size());
+
+  for(size_t rank : ranks){
+    if(rank >= SIZE){
+      throw std::out_of_range("rank out of range");
+    }
+  }
+
+  if(ranks.empty()){
+    return result;
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the vector and the ordered keys
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> key_buffer{sycl::range<1>{SIZE}};
+
+    // executing a sycl kernel that maps the elements to ordered keys
+    Q.submit([&](sycl::handler &h){
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor key_access{key_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        key_access[idx] = radix_key_from_double(A_access[idx]);
+      });
+    });
+
+    // selecting the distinct ranks together, in ascending order
+    std::vector<size_t> distinct(ranks);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    const std::vector<uint64_t> selected = radix_select_buffer(Q, key_buffer, SIZE, distinct);
+
+    for(size_t rank : ranks){
+      const size_t d = std::lower_bound(distinct.begin(), distinct.end(), rank) - distinct.begin();
+      result.push_back(double_from_radix_key(selected[d]));
+    }
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Basic_Sycl_Vector::kth_element(size_t k){
+  return select_ranks({k})[0];
+}
+
+////////////////////////////////////////////////////////////////////////
+std::pair<py::array_t<double>, py::array_t<int64_t>> Basic_Sycl_Vector::top_k(size_t k){
+  k = std::min(k, SIZE);
+  std::shared_ptr<double> values = allocate_storage<double>(k);
+  std::shared_ptr<int64_t> indices = allocate_storage<int64_t>(k);
+
+  if(k > 0){
+    // the k-th largest element splits the survivors into those above it,
+    // which are all kept, and ties, of which the lowest indices are kept
+    const uint64_t threshold = radix_key_from_double(select_ranks({SIZE - k})[0]);
+    auto above = compact_if([=](double value){ return radix_key_from_double(value) > threshold; });
+    auto ties  = compact_if([=](double value){ return radix_key_from_double(value) == threshold; });
+
+    std::vector<std::pair<uint64_t, int64_t>> order;
+    order.reserve(k);
+    for(size_t i = 0; i < above.first.SIZE; ++i){
+      order.emplace_back(radix_key_from_double(above.first.A.get()[i]), above.second.data()[i]);
+    }
+    for(size_t i = 0; order.size() < k; ++i){
+      order.emplace_back(threshold, ties.second.data()[i]);
+    }
+
+    // ordering the k survivors by descending value and ascending index
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b){
+      return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for(size_t i = 0; i < k; ++i){
+      values.get()[i]  = double_from_radix_key(order[i].first);
+      indices.get()[i] = order[i].second;
+    }
+  }
+
+  return {share_storage(values, k), share_storage(indices, k)};
+}
+
+////////////////////////////////////////////////////////////////////////
+double Basic_Sycl_Vector::median(){
+  return quantiles({0.5})[0];
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Basic_Sycl_Vector::quantiles(const std::vector<double>& q){
+  if(SIZE == 0){
+    throw std::invalid_argument("quantiles of an empty vector");
+  }
+
+  // collecting the ranks around each quantile position, the upper one
+  // only when the position falls between two ranks
+  std::vector<size_t> ranks;
+  std::vector<size_t> first(q.size());
+  ranks.reserve(2*q.size());
+  for(size_t i = 0; i < q.size(); ++i){
+    if(!(q[i] >= 0.0 && q[i] <= 1.0)){
+      throw std::invalid_argument("quantiles must be between 0 and 1");
+    }
+    const double position = q[i]*static_cast<double>(SIZE - 1);
+    const size_t lower = static_cast<size_t>(position);
+    first[i] = ranks.size();
+    ranks.push_back(lower);
+    if(position != static_cast<double>(lower)){
+      ranks.push_back(lower + 1);
+    }
+  }
+
+  const std::vector<double> selected = select_ranks(ranks);
+
+  std::vector<double> result;
+  result.reserve(q.size());
+  for(size_t i = 0; i < q.size(); ++i){
+    const double position = q[i]*static_cast<double>(SIZE - 1);
+    const double fraction = position - static_cast<double>(ranks[first[i]]);
+    const double lower = selected[first[i]];
+    result.push_back(fraction == 0.0 ? lower : lower + (selected[first[i] + 1] - lower)*fraction);
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Basic_Sycl_Vector::histogram_counts(const Histogram_Bins& bins,
+                                                         const std::vector<double>& edges){
+  std::shared_ptr<int64_t> counts = allocate_storage<int64_t>(bins.N_BINS);
+
+  if(SIZE > 0){
+    // creating buffers for the vector, the edges and the counts
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    std::vector<double> edge_values = edges.empty() ? std::vector<double>{0.0} : edges;
+    sycl::buffer<double> edge_buffer{edge_values.data(), sycl::range<1>{edge_values.size()}};
+    sycl::buffer<int64_t> count_buffer{counts.get(), sycl::range<1>{bins.N_BINS}};
+
+    histogram_buffer(Q, A_buffer, SIZE, bins, edge_buffer, count_buffer);
+  }
+
+  return share_storage(counts, bins.N_BINS);
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Basic_Sycl_Vector::histogram(size_t N_BINS, double lo, double hi){
+  return histogram_counts(make_histogram_bins(N_BINS, lo, hi, false), {});
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Basic_Sycl_Vector::histogram_log(size_t N_BINS, double lo, double hi){
+  return histogram_counts(make_histogram_bins(N_BINS, lo, hi, true), {});
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Basic_Sycl_Vector::histogram_edges(const std::vector<double>& edges){
+  return histogram_counts(make_histogram_bins(edges), edges);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::optional<double> Basic_Sycl_Vector::kernel_time(sycl::event& kernel_event){
+  return kernel_event_time(Q, kernel_event);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Basic_Sycl_Vector::get_vector(){
+  return std::vector<double>(A.get(), A.get() + SIZE);
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<double> Basic_Sycl_Vector::get_array(){
+  return share_storage(A, SIZE);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::save(const std::string& path, bool direct){
+  const bool NPZ = path.size() >= 4 && path.compare(path.size() - 4, 4, ".npz") == 0;
+  const std::string member = "arr_0.npy";
+
+  // the values start on an O_DIRECT boundary when direct is set
+  const size_t ALIGNMENT = direct ? IO_DIRECT_ALIGNMENT : 64;
+  const std::string header = make_npy_header(SIZE, ALIGNMENT);
+  const size_t BYTES = SIZE*sizeof(double);
+  const size_t LOCAL_BYTES  = NPZ ? zip_local_header(member, 0, 0, ALIGNMENT).size() : 0;
+  const size_t MEMBER_BYTES = header.size() + BYTES;
+
+  File_Descriptor file(path, O_WRONLY | O_CREAT | O_TRUNC);
+  File_Descriptor direct_file = direct ? File_Descriptor::try_open(path, O_WRONLY | O_DIRECT) : File_Descriptor();
+
+  // sizing the file first so the writers never extend it concurrently
+  if(ftruncate(file.get(), static_cast<off_t>(LOCAL_BYTES + MEMBER_BYTES)) != 0){
+    throw std::runtime_error("cannot resize " + path + ": " + std::strerror(errno));
+  }
+
+  int error = write_exact(file.get(), header.data(), header.size(), LOCAL_BYTES);
+  const uint32_t values_crc = write_parallel(file.get(), direct_file.get(), reinterpret_cast<const char*>(A.get()),
+                                             BYTES, LOCAL_BYTES + header.size(), NPZ);
+
+  if(NPZ && error == 0){
+    // the local header needs the checksum, so it is written last
+    const uint32_t crc = crc32_combine(crc32_update(0, header.data(), header.size()), values_crc, BYTES);
+    const std::string local   = zip_local_header(member, MEMBER_BYTES, crc, ALIGNMENT);
+    const std::string central = zip_central_directory(member, MEMBER_BYTES, crc, LOCAL_BYTES + MEMBER_BYTES);
+    error = write_exact(file.get(), local.data(), local.size(), 0);
+    if(error == 0){
+      error = write_exact(file.get(), central.data(), central.size(), LOCAL_BYTES + MEMBER_BYTES);
+    }
+  }
+  if(error != 0){
+    throw std::runtime_error("cannot write " + path + ": " + std::strerror(error));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::load(const std::string& path, bool mmap, bool direct, const std::string& key){
+  File_Descriptor file(path, O_RDONLY);
+  const size_t FILE_BYTES = file.size();
+
+  // locating the .npy data, inside the archive for .npz files
+  size_t member_offset = 0;
+  size_t member_bytes  = FILE_BYTES;
+  const std::string magic = read_string(file.get(), std::min<size_t>(FILE_BYTES, 4), 0);
+  if(magic.size() == 4 && get_le<uint32_t>(magic.data()) == ZIP_LOCAL_SIGNATURE){
+    const Zip_Member zip_member = find_zip_member(file.get(), FILE_BYTES, key);
+    if(zip_member.method != ZIP_STORED){
+      throw std::invalid_argument("member " + zip_member.name + " is compressed, only stored .npz members "
+                                  "(numpy.savez, not savez_compressed) can be loaded");
+    }
+    member_offset = zip_member.data_offset;
+    member_bytes  = zip_member.size;
+  }
+
+  const std::string prefix = read_string(file.get(), std::min(member_bytes, NPY_PREFIX_BYTES), member_offset);
+  const size_t HEADER_BYTES = npy_header_bytes(prefix.data(), prefix.size());
+  if(HEADER_BYTES > member_bytes){
+    throw std::invalid_argument(path + " has a truncated .npy header");
+  }
+  const std::string header_bytes = read_string(file.get(), HEADER_BYTES, member_offset);
+  const Npy_Header header = parse_npy_header(header_bytes.data(), header_bytes.size(), member_bytes);
+
+  const size_t OFFSET = member_offset + header.data_offset;
+  const size_t BYTES  = header.SIZE*sizeof(double);
+  if(header.data_offset + BYTES > member_bytes){
+    throw std::invalid_argument(path + " is shorter than its .npy header says");
+  }
+
+  // mapping needs aligned values, which numpy guarantees for .npy files
+  // but not for .npz members, those are read instead
+  if(mmap && BYTES > 0 && OFFSET % alignof(double) == 0){
+    return Basic_Sycl_Vector(header.SIZE, map_file_storage<double>(file.get(), OFFSET, header.SIZE));
+  }
+
+  std::shared_ptr<double> storage = allocate_storage<double>(header.SIZE);
+  File_Descriptor direct_file = direct ? File_Descriptor::try_open(path, O_RDONLY | O_DIRECT) : File_Descriptor();
+  read_parallel(file.get(), direct_file.get(), reinterpret_cast<char*>(storage.get()), BYTES, OFFSET);
+  return Basic_Sycl_Vector(header.SIZE, std::move(storage));
+}
+
+////////////////////////////////////////////////////////////////////////
+void Basic_Sycl_Vector::save_compressed(const std::string& path, const std::string& codec, size_t chunk_size){
+  write_chunked(path, A.get(), SIZE, vector_codec_from_name(codec), chunk_size);
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::load_compressed(const std::string& path, size_t begin, size_t end){
+  const Chunked_File chunked = open_chunked(path);
+  end = std::min(end, chunked.SIZE);
+  if(begin > end){
+    throw std::out_of_range("begin is past the end of the range");
+  }
+
+  Basic_Sycl_Vector result(end - begin);
+  read_chunked(chunked, begin, end, result.A.get());
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+Basic_Sycl_Vector Basic_Sycl_Vector::load_text(const std::string& path, const std::string& delimiter, size_t skip_rows,
+                                               const std::string& comments){
+  const char DELIMITER = text_option(delimiter, "delimiter");
+  const char COMMENT   = text_option(comments, "comments");
+  if(DELIMITER != '\0' && DELIMITER == COMMENT){
+    throw std::invalid_argument("delimiter and comments must differ");
+  }
+
+  File_Descriptor file(path, O_RDONLY);
+  const size_t BYTES = file.size();
+  const std::shared_ptr<const char> text = map_text_file(file.get(), BYTES);
+
+  const Text_Segments segments = split_text(text.get(), BYTES, skip_rows, DELIMITER, COMMENT);
+  Basic_Sycl_Vector result(segments.SIZE);
+  parse_text(text.get(), segments, DELIMITER, COMMENT, result.A.get());
+  return result;
+}
+
+// Batches of vectors
+#include "vector_batch.cpp"
+
+// Ragged vectors
+#include "ragged_vector.cpp"
+
+// Packed boolean vectors
+#include "bit_vector.cpp"
+
+// File backed vectors
+#include "mapped_vector.cpp"
+
+// Asynchronous checkpoints
+#include "checkpoint.cpp"
+
+// Streaming pipelines
+#include "stream_pipeline.cpp"
+
+// Sliding windows
+#include "ring_vector.cpp"
+
+#endif //#ifndef BASIC_VECTOR_CPP
+
+
+PYBIND11_MODULE(sycl_vector, m){
+  m.doc() = R"myDelim(
+    User guide documentation for the 'Basic Sycl Vector' module.
+    ------------------------------------------------------------
+
+    .. currentmodule:: basic sycl vector
+
+    .. autosummary::
+      :toctree: _generate
+
+      print_device
+      select_gpu_device
+      reset
+      fill
+      iota
+      arange
+      linspace
+      logspace
+      add_each_element
+      subtract_each_element
+      multiply_each_element
+      divide_each_element
+      enable_profiling
+      apply_batch
+      exp
+      log
+      sqrt
+      pow
+      sin
+      cos
+      tanh
+      erf
+      fma
+      polyval
+      ppval
+      fill_uniform
+      fill_normal
+      fill_exponential
+      add_uniform_noise
+      add_normal_noise
+      add_each_block
+      subtract_each_block
+      multiply_each_block
+      divide_each_block
+      apply_batch_each_block
+      apply_batch_masked
+      add_each_element_masked
+      subtract_each_element_masked
+      multiply_each_element_masked
+      divide_each_element_masked
+      clip
+      where
+      inclusive_scan
+      exclusive_scan
+      inclusive_scan_copy
+      exclusive_scan_copy
+      filter
+      remove_nonfinite
+      compact
+      compare
+      any
+      all
+      count_if
+      find_first
+      sum
+      min
+      max
+      sort
+      argsort
+      kth_element
+      top_k
+      median
+      quantiles
+      histogram
+      histogram_log
+      histogram_edges
+      get_array
+      save
+      load
+      save_compressed
+      load_compressed
+      load_text
+      checkpoint
+      restore
+      sycl_vector_batch
+      sycl_ragged_vector
+      sycl_bit_vector
+      sycl_mapped_vector
+      sycl_checkpoint
+      sycl_restore
+      sycl_stream
+      sycl_ring_vector
+
+  )myDelim";
+
+  py::class_<Basic_Sycl_Vector>(m, "basic_sycl_vector").def(py::init<size_t, bool>(), py::arg("SIZE"), py::arg("huge_pages") = false, R"myDelim(
+    Initialize a basic sycl vector with some input size 'SIZE'
+
+    Parameters
+    ----------
     SIZE
+    huge_pages
+      Back large vectors with transparent huge pages
+  )myDelim").def(py::init<py::array_t<double, py::array::c_style>>(), py::arg("values").noconvert(), R"myDelim(
+    Initialize a basic sycl vector that shares the memory of a float64,
+    C-contiguous NumPy array without copying
+
+    Parameters
+    ----------
+    values
   )myDelim").def("print_device", &Basic_Sycl_Vector::print_device, R"myDelim(
     Prints the selected device for SYCL queue
   )myDelim").def("select_gpu_device", &Basic_Sycl_Vector::select_gpu_device, R"myDelim(
     Selects GPU for SYCL queue
+  )myDelim").def("enable_profiling", &Basic_Sycl_Vector::enable_profiling, R"myDelim(
+    Enables or disables kernel profiling for SYCL queue
   )myDelim").def("reset", &Basic_Sycl_Vector::reset, R"myDelim(
     Resets every vector input to be zero
+  )myDelim").def("fill", &Basic_Sycl_Vector::fill, R"myDelim(
+    Sets every vector element to value on the device
+  )myDelim").def("iota", &Basic_Sycl_Vector::iota, py::arg("start") = 0.0, py::arg("step") = 1.0, R"myDelim(
+    Sets element i to start + i*step on the device
+  )myDelim").def_static("arange", &Basic_Sycl_Vector::arange, py::arg("start"), py::arg("stop"), py::arg("step") = 1.0, R"myDelim(
+    Returns a new vector with the values start, start + step, ... up to but
+    excluding stop, generated on the device as in numpy.arange
+  )myDelim").def_static("linspace", &Basic_Sycl_Vector::linspace, py::arg("start"), py::arg("stop"), py::arg("num") = 50, py::arg("endpoint") = true, R"myDelim(
+    Returns a new vector with num evenly spaced values from start to stop,
+    generated on the device as in numpy.linspace
+  )myDelim").def_static("logspace", &Basic_Sycl_Vector::logspace, py::arg("start"), py::arg("stop"), py::arg("num") = 50, py::arg("base") = 10.0, py::arg("endpoint") = true, R"myDelim(
+    Returns a new vector with num values from base**start to base**stop,
+    evenly spaced on a log scale and generated on the device as in
+    numpy.logspace
   )myDelim").def("add_each_element", &Basic_Sycl_Vector::add_each_element<double>, R"myDelim(
     Adds a specific value x to each vector element
   )myDelim").def("subtract_each_element", &Basic_Sycl_Vector::subtract_each_element<double>, R"myDelim(
@@ -249,5 +1958,595 @@ PYBIND11_MODULE(sycl_vector, m){
     Multiplies a specific value x to each vector element
   )myDelim").def("divide_each_element", &Basic_Sycl_Vector::divide_each_element<double>, R"myDelim(
     Divides a specific value x to each vector element
+  )myDelim").def("exp", &Basic_Sycl_Vector::exp, py::arg("native") = false, R"myDelim(
+    Replaces each element by its exponential, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("log", &Basic_Sycl_Vector::log, py::arg("native") = false, R"myDelim(
+    Replaces each element by its natural logarithm, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("sqrt", &Basic_Sycl_Vector::sqrt, py::arg("native") = false, R"myDelim(
+    Replaces each element by its square root, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("pow", &Basic_Sycl_Vector::pow, py::arg("p"), py::arg("native") = false, R"myDelim(
+    Raises each element to the power p, with native=True in single
+    precision
+  )myDelim").def("sin", &Basic_Sycl_Vector::sin, py::arg("native") = false, R"myDelim(
+    Replaces each element by its sine, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("cos", &Basic_Sycl_Vector::cos, py::arg("native") = false, R"myDelim(
+    Replaces each element by its cosine, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("tanh", &Basic_Sycl_Vector::tanh, py::arg("native") = false, R"myDelim(
+    Replaces each element by its hyperbolic tangent, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("erf", &Basic_Sycl_Vector::erf, py::arg("native") = false, R"myDelim(
+    Replaces each element by its error function, native=True uses the fast
+    single precision builtins instead of full double precision
+  )myDelim").def("fma", py::overload_cast<double, double>(&Basic_Sycl_Vector::fma), py::arg("a"), py::arg("b"), R"myDelim(
+    Replaces each element v by v*a + b with a fused multiply-add
+  )myDelim").def("fma", py::overload_cast<const Basic_Sycl_Vector&, const Basic_Sycl_Vector&>(&Basic_Sycl_Vector::fma), py::arg("a"), py::arg("b"), R"myDelim(
+    Replaces each element v[i] by v[i]*a[i] + b[i] with a fused
+    multiply-add, where a and b are vectors of the same size
+  )myDelim").def("polyval", &Basic_Sycl_Vector::polyval, R"myDelim(
+    Replaces each element by the polynomial with the given coefficients
+    evaluated at it in a single kernel, highest degree first as in
+    numpy.polyval
+  )myDelim").def("ppval", &Basic_Sycl_Vector::ppval, py::arg("breaks"), py::arg("coefficients"), R"myDelim(
+    Replaces each element by a piecewise polynomial evaluated at it in a
+    single kernel, such as a spline
+
+    Parameters
+    ----------
+    breaks
+      Increasing breaks, one more than the number of pieces
+    coefficients
+      Coefficients of each piece, highest degree first, evaluated at
+      v - breaks[i] for breaks[i] <= v < breaks[i + 1]. Elements outside the
+      breaks use the first or last piece. For a scipy.interpolate.CubicSpline
+      s this is ppval(s.x, s.c.T)
+  )myDelim").def("fill_uniform", &Basic_Sycl_Vector::fill_uniform, py::arg("lo") = 0.0, py::arg("hi") = 1.0, py::arg("seed") = 0, R"myDelim(
+    Fills the vector with uniform samples in [lo, hi) drawn on the device
+    with the Philox4x32-10 generator, element i always gets the same sample
+    for a given seed
+  )myDelim").def("fill_normal", &Basic_Sycl_Vector::fill_normal, py::arg("mean") = 0.0, py::arg("stddev") = 1.0, py::arg("seed") = 0, R"myDelim(
+    Fills the vector with normal samples, see fill_uniform
+  )myDelim").def("fill_exponential", &Basic_Sycl_Vector::fill_exponential, py::arg("rate") = 1.0, py::arg("seed") = 0, R"myDelim(
+    Fills the vector with exponential samples of the given rate, see
+    fill_uniform
+  )myDelim").def("add_uniform_noise", &Basic_Sycl_Vector::add_uniform_noise, py::arg("lo"), py::arg("hi"), py::arg("seed") = 0, R"myDelim(
+    Adds uniform noise in [lo, hi) to each element, see fill_uniform
+  )myDelim").def("add_normal_noise", &Basic_Sycl_Vector::add_normal_noise, py::arg("stddev"), py::arg("seed") = 0, R"myDelim(
+    Adds zero mean normal noise to each element, see fill_uniform
+  )myDelim").def("add_each_block", &Basic_Sycl_Vector::add_each_block, R"myDelim(
+    Adds x[k] to each element of block k, where element i belongs to block
+    (i // block_size) % len(x). Use block_size = len(vector) // len(x) for
+    contiguous blocks and block_size = 1 for interleaved channels
+  )myDelim").def("subtract_each_block", &Basic_Sycl_Vector::subtract_each_block, R"myDelim(
+    Subtracts x[k] to each element of block k
+  )myDelim").def("multiply_each_block", &Basic_Sycl_Vector::multiply_each_block, R"myDelim(
+    Multiplies x[k] to each element of block k
+  )myDelim").def("divide_each_block", &Basic_Sycl_Vector::divide_each_block, R"myDelim(
+    Divides x[k] to each element of block k
+  )myDelim").def("apply_batch_each_block", &Basic_Sycl_Vector::apply_batch_each_block, R"myDelim(
+    Applies a chain of operations in a single kernel, where operation j uses
+    the scalar x[j][k] on the elements of block k, for example
+    apply_batch_each_block([1, 3], [means, stds], 1) normalizes interleaved
+    channels
+
+    Parameters
+    ----------
+    op_codes
+      Operation codes, see apply_batch
+    x
+      Scalar vector for each operation, all of the same length
+    block_size
+      Number of consecutive elements that share a scalar
+
+    Returns
+    -------
+    Kernel time in seconds when profiling is enabled, otherwise None
+  )myDelim").def("apply_batch_masked", &Basic_Sycl_Vector::apply_batch_masked, R"myDelim(
+    Applies a chain of operations in a single kernel to the elements whose
+    bit is set in a packed mask, the other elements keep their value
+
+    Parameters
+    ----------
+    op_codes
+      Operation codes, see apply_batch
+    x
+      Scalar value for each operation
+    mask
+      uint64 array with one bit per element, element i is bit i % 64 of
+      word i // 64, as numpy.packbits(m, bitorder="little").view(numpy.uint64)
+      on a mask padded to a multiple of 64
+
+    Returns
+    -------
+    Kernel time in seconds when profiling is enabled, otherwise None
+  )myDelim").def("add_each_element_masked", &Basic_Sycl_Vector::add_each_element_masked, R"myDelim(
+    Adds some value x to each element whose bit is set in a packed mask,
+    see apply_batch_masked
+  )myDelim").def("subtract_each_element_masked", &Basic_Sycl_Vector::subtract_each_element_masked, R"myDelim(
+    Subtracts some value x from each element whose bit is set in a packed
+    mask, see apply_batch_masked
+  )myDelim").def("multiply_each_element_masked", &Basic_Sycl_Vector::multiply_each_element_masked, R"myDelim(
+    Multiplies each element whose bit is set in a packed mask by some value
+    x, see apply_batch_masked
+  )myDelim").def("divide_each_element_masked", &Basic_Sycl_Vector::divide_each_element_masked, R"myDelim(
+    Divides each element whose bit is set in a packed mask by some value x,
+    see apply_batch_masked
+  )myDelim").def("clip", &Basic_Sycl_Vector::clip, py::arg("lo"), py::arg("hi"), R"myDelim(
+    Limits each element to the range [lo, hi], NaNs are kept
+  )myDelim").def_static("where", &Basic_Sycl_Vector::where, py::arg("mask"), py::arg("a"), py::arg("b"), R"myDelim(
+    Returns a new vector that takes element i from a where bit i of a packed
+    mask is set and from b otherwise, see apply_batch_masked for the mask
+    layout
+  )myDelim").def("inclusive_scan", &Basic_Sycl_Vector::inclusive_scan, py::arg("op") = "sum", R"myDelim(
+    Replaces the vector by its inclusive scan with the operation op
+    ("sum", "prod", "min" or "max")
+  )myDelim").def("exclusive_scan", &Basic_Sycl_Vector::exclusive_scan, py::arg("op") = "sum", R"myDelim(
+    Replaces the vector by its exclusive scan with the operation op
+    ("sum", "prod", "min" or "max")
+  )myDelim").def("inclusive_scan_copy", &Basic_Sycl_Vector::inclusive_scan_copy, py::arg("op") = "sum", R"myDelim(
+    Returns the inclusive scan of the vector as a new vector
+  )myDelim").def("exclusive_scan_copy", &Basic_Sycl_Vector::exclusive_scan_copy, py::arg("op") = "sum", R"myDelim(
+    Returns the exclusive scan of the vector as a new vector
+  )myDelim").def("filter", &Basic_Sycl_Vector::filter, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns the elements that satisfy a comparison as a new vector,
+    together with a NumPy array of their indices
+
+    Parameters
+    ----------
+    op
+      One of "<", "<=", ">", ">=", "==", "!=" (compared with x), "inside" or
+      "outside" (the closed range [x, y]), "nan", "inf" or "finite"
+    x
+    y
+  )myDelim").def("remove_nonfinite", &Basic_Sycl_Vector::remove_nonfinite, R"myDelim(
+    Returns the finite elements as a new vector, together with a NumPy
+    array of their indices
+  )myDelim").def("compact", &Basic_Sycl_Vector::compact, R"myDelim(
+    Returns the elements where a boolean mask is true as a new vector,
+    together with a NumPy array of their indices
+  )myDelim").def("compare", &Basic_Sycl_Vector::compare, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns a sycl_bit_vector that is set where the element satisfies the
+    comparison, see any for the comparisons
+  )myDelim").def("any", &Basic_Sycl_Vector::any, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns True when an element satisfies the comparison, the device
+    search stops at the first hit
+
+    Parameters
+    ----------
+    op
+      One of "<", "<=", ">", ">=", "==", "!=" (compared with x), "inside" or
+      "outside" (the closed range [x, y]), "nan", "inf" or "finite"
+    x
+    y
+  )myDelim").def("all", &Basic_Sycl_Vector::all, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns True when every element satisfies the comparison, the device
+    search stops at the first element that does not, see any
+  )myDelim").def("count_if", &Basic_Sycl_Vector::count_if, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns the number of elements that satisfy the comparison, see any
+  )myDelim").def("find_first", &Basic_Sycl_Vector::find_first, py::arg("op"), py::arg("x") = 0.0, py::arg("y") = 0.0, R"myDelim(
+    Returns the index of the first element that satisfies the comparison,
+    or -1 when there is none, see any
+  )myDelim").def("sum", &Basic_Sycl_Vector::sum, R"myDelim(
+    Returns the sum of the elements, reduced in a fixed order so the
+    result is reproducible
+  )myDelim").def("min", &Basic_Sycl_Vector::min, R"myDelim(
+    Returns the minimum of the elements
+  )myDelim").def("max", &Basic_Sycl_Vector::max, R"myDelim(
+    Returns the maximum of the elements
+  )myDelim").def("sort", &Basic_Sycl_Vector::sort, R"myDelim(
+    Sorts the vector in ascending order with a device radix sort, NaNs go
+    last
+  )myDelim").def("argsort", &Basic_Sycl_Vector::argsort, R"myDelim(
+    Returns a NumPy array of the indices that sort the vector in ascending
+    order, equal elements keep their original order
+  )myDelim").def("kth_element", &Basic_Sycl_Vector::kth_element, R"myDelim(
+    Returns the element that would be at index k if the vector was sorted,
+    found by radix select without sorting
+  )myDelim").def("top_k", &Basic_Sycl_Vector::top_k, R"myDelim(
+    Returns NumPy arrays of the k largest elements in descending order and
+    of their indices, ties keep the lowest indices
+  )myDelim").def("median", &Basic_Sycl_Vector::median, R"myDelim(
+    Returns the median of the vector
+  )myDelim").def("quantiles", &Basic_Sycl_Vector::quantiles, R"myDelim(
+    Returns the quantiles q (between 0 and 1) of the vector, with linear
+    interpolation between neighbouring elements as in numpy.quantile
+  )myDelim").def("histogram", &Basic_Sycl_Vector::histogram, py::arg("bins"), py::arg("lo"), py::arg("hi"), R"myDelim(
+    Returns a NumPy array with the counts in equal width bins over [lo, hi],
+    the last bin includes hi and elements outside the range are ignored
+
+    Parameters
+    ----------
+    bins
+      Number of bins
+    lo
+    hi
+  )myDelim").def("histogram_log", &Basic_Sycl_Vector::histogram_log, py::arg("bins"), py::arg("lo"), py::arg("hi"), R"myDelim(
+    Returns a NumPy array with the counts in bins of equal width in log
+    space over [lo, hi], with 0 < lo
+
+    Parameters
+    ----------
+    bins
+      Number of bins
+    lo
+    hi
+  )myDelim").def("histogram_edges", &Basic_Sycl_Vector::histogram_edges, R"myDelim(
+    Returns a NumPy array with the counts in the bins between consecutive
+    increasing edges, as numpy.histogram with explicit bins
+  )myDelim").def("get_vector", &Basic_Sycl_Vector::get_vector, R"myDelim(
+    Returns a copy of the vector as a list
+  )myDelim").def("get_array", &Basic_Sycl_Vector::get_array, R"myDelim(
+    Returns a NumPy array that shares the vector storage without copying
+  )myDelim").def("save", &Basic_Sycl_Vector::save, py::arg("path"), py::arg("direct") = false, R"myDelim(
+    Saves the vector as a .npy file, or as a .npz archive holding arr_0
+    when path ends in .npz, readable by numpy.load. The data is written by
+    several threads at their own offsets, with 'direct' the bulk of it
+    bypasses the page cache through O_DIRECT where the file system allows
+
+    Parameters
+    ----------
+    path
+    direct
+  )myDelim").def_static("load", &Basic_Sycl_Vector::load, py::arg("path"), py::arg("mmap") = false, py::arg("direct") = false, py::arg("key") = "", R"myDelim(
+    Loads a float64 vector from a .npy file or from a stored member of a
+    .npz archive ('key', the first member when empty). With 'mmap' the
+    file is mapped copy-on-write and adopted without copying, changes to
+    the vector never reach the file. Otherwise the data is read by several
+    threads, with 'direct' through O_DIRECT where the file system allows
+
+    Parameters
+    ----------
+    path
+    mmap
+    direct
+    key
+  )myDelim").def("save_compressed", &Basic_Sycl_Vector::save_compressed, py::arg("path"), py::arg("codec") = "xor",
+                 py::arg("chunk_size") = CHUNKED_CHUNK_SIZE, R"myDelim(
+    Saves the vector in a chunked file with an index of the chunks, each
+    chunk compressed on its own by a host thread. Chunks that do not
+    shrink are stored raw
+
+    Parameters
+    ----------
+    path
+    codec
+      "xor" (XOR with the previous value, suited to smooth or integral
+      data), "raw", or "shuffle_lz4" / "shuffle_zstd" (byte shuffle and a
+      general purpose compressor) when the module is built with lz4 / zstd
+    chunk_size
+      Number of elements per chunk
+  )myDelim").def_static("load_compressed", &Basic_Sycl_Vector::load_compressed, py::arg("path"), py::arg("begin") = 0,
+                        py::arg("end") = std::numeric_limits<size_t>::max(), R"myDelim(
+    Loads the elements [begin, end) of a file written by save_compressed,
+    the whole vector by default. Only the chunks that overlap the range are
+    read and they are decoded in parallel
+
+    Parameters
+    ----------
+    path
+    begin
+    end
+  )myDelim").def_static("load_text", &Basic_Sycl_Vector::load_text, py::arg("path"), py::arg("delimiter") = ",",
+                        py::arg("skip_rows") = 0, py::arg("comments") = "#", R"myDelim(
+    Loads the numbers of a text file in row major order as a flat vector.
+    Values are separated by whitespace, line breaks and the delimiter, so
+    CSV and whitespace separated files both load with the default. The
+    file is mapped and its segments are parsed by several threads straight
+    into the vector
+
+    Parameters
+    ----------
+    path
+    delimiter
+      Single character, empty for whitespace only. Empty fields between
+      delimiters are errors
+    skip_rows
+      Number of leading lines to skip, such as a header
+    comments
+      Single character that starts a comment running to the end of the
+      line, empty for none
+  )myDelim").def("checkpoint", &Basic_Sycl_Vector::checkpoint, py::arg("path"), py::arg("codec") = "", R"myDelim(
+    Takes a snapshot of the vector and writes it to path on a background
+    I/O thread, returning a sycl_checkpoint handle at once. The file is
+    written under a temporary name and renamed when complete
+
+    Parameters
+    ----------
+    path
+    codec
+      Empty for .npy (or .npz when path ends in .npz), otherwise a codec
+      of save_compressed
+  )myDelim").def_static("restore", &Basic_Sycl_Vector::restore, py::arg("path"), R"myDelim(
+    Loads a file written by checkpoint, save or save_compressed on the
+    background I/O thread, returning a sycl_restore handle at once. Jobs
+    run in submission order, so a restore sees earlier checkpoints
+
+    Parameters
+    ----------
+    path
+  )myDelim").def("apply_batch", py::overload_cast<const std::vector<int>&, const std::vector<double>&>(&Basic_Sycl_Vector::apply_batch), R"myDelim(
+    Applies a chain of operations to each vector element in a single kernel
+
+    Parameters
+    ----------
+    op_codes
+      Operation codes (0 add, 1 subtract, 2 multiply, 3 divide, 4 exp,
+      5 log, 6 sqrt, 7 pow, 8 sin, 9 cos, 10 tanh, 11 erf), the math
+      function codes plus 256 use the fast single precision builtins
+    x
+      Scalar value for each operation, the exponent for pow and ignored by
+      the other math functions
+
+    Returns
+    -------
+    Kernel time in seconds when profiling is enabled, otherwise None
+  )myDelim").def("apply_batch", py::overload_cast<const std::string&>(&Basic_Sycl_Vector::apply_batch), R"myDelim(
+    Applies a chain of operations written as an op string such as
+    "+2 *3.5 /4", "add 2; mul 3" or "*2 +1 log" (log(2x + 1)) to each
+    vector element in a single kernel, math functions other than pow take
+    no scalar and a "native_" prefix selects their fast variant
+
+    Returns
+    -------
+    Kernel time in seconds when profiling is enabled, otherwise None
+  )myDelim");
+
+  py::class_<Sycl_Vector_Batch>(m, "sycl_vector_batch").def(py::init<const std::vector<size_t>&>(), R"myDelim(
+    Initialize a batch of zero vectors with the given sizes
+
+    Parameters
+    ----------
+    sizes
+  )myDelim").def(py::init<const std::vector<std::vector<double>>&>(), R"myDelim(
+    Initialize a batch holding copies of the given vectors
+
+    Parameters
+    ----------
+    vectors
+  )myDelim").def("size", &Sycl_Vector_Batch::size, R"myDelim(
+    Returns the number of vectors in the batch
+  )myDelim").def("enable_profiling", &Sycl_Vector_Batch::enable_profiling, R"myDelim(
+    Enables or disables kernel profiling for SYCL queue
+  )myDelim").def("add_each_element", &Sycl_Vector_Batch::add_each_element<double>, R"myDelim(
+    Adds a specific value x to each element of every vector
+  )myDelim").def("subtract_each_element", &Sycl_Vector_Batch::subtract_each_element<double>, R"myDelim(
+    Subtracts a specific value x to each element of every vector
+  )myDelim").def("multiply_each_element", &Sycl_Vector_Batch::multiply_each_element<double>, R"myDelim(
+    Multiplies a specific value x to each element of every vector
+  )myDelim").def("divide_each_element", &Sycl_Vector_Batch::divide_each_element<double>, R"myDelim(
+    Divides a specific value x to each element of every vector
+  )myDelim").def("apply_batch", &Sycl_Vector_Batch::apply_batch, R"myDelim(
+    Applies a chain of operations to each element of every vector in a
+    single kernel, returns the kernel time in seconds when profiling is
+    enabled, otherwise None
+  )myDelim").def("sum_each_vector", &Sycl_Vector_Batch::sum_each_vector, R"myDelim(
+    Returns the sum of each vector
+  )myDelim").def("min_each_vector", &Sycl_Vector_Batch::min_each_vector, R"myDelim(
+    Returns the minimum of each vector
+  )myDelim").def("max_each_vector", &Sycl_Vector_Batch::max_each_vector, R"myDelim(
+    Returns the maximum of each vector
+  )myDelim").def("get_vector", &Sycl_Vector_Batch::get_vector, R"myDelim(
+    Returns the vector at index i
+  )myDelim").def("get_arena", &Sycl_Vector_Batch::get_arena, R"myDelim(
+    Returns a NumPy array that shares the arena holding the elements of
+    all vectors
+  )myDelim").def("get_offsets", &Sycl_Vector_Batch::get_offsets, R"myDelim(
+    Returns the start of each vector in the arena
+  )myDelim");
+
+  py::class_<Sycl_Ragged_Vector>(m, "sycl_ragged_vector").def(py::init<const std::vector<size_t>&>(), R"myDelim(
+    Initialize a ragged vector of zero segments with the given sizes
+
+    Parameters
+    ----------
+    sizes
+  )myDelim").def(py::init<py::array_t<double, py::array::c_style>, py::array_t<int64_t, py::array::c_style>>(),
+                 py::arg("values").noconvert(), py::arg("offsets").noconvert(), R"myDelim(
+    Initialize a ragged vector that shares the memory of float64 values and
+    int64 offsets NumPy arrays without copying, segment s holds
+    values[offsets[s]:offsets[s + 1]]
+
+    Parameters
+    ----------
+    values
+    offsets
+  )myDelim").def("size", &Sycl_Ragged_Vector::size, R"myDelim(
+    Returns the number of segments
+  )myDelim").def("sum_each_segment", &Sycl_Ragged_Vector::sum_each_segment, R"myDelim(
+    Returns the sum of each segment
+  )myDelim").def("min_each_segment", &Sycl_Ragged_Vector::min_each_segment, R"myDelim(
+    Returns the minimum of each segment
+  )myDelim").def("max_each_segment", &Sycl_Ragged_Vector::max_each_segment, R"myDelim(
+    Returns the maximum of each segment
+  )myDelim").def("inclusive_scan_each_segment", &Sycl_Ragged_Vector::inclusive_scan_each_segment, py::arg("op") = "sum", R"myDelim(
+    Replaces each segment by its inclusive scan with the operation op
+    ("sum", "prod", "min" or "max")
+  )myDelim").def("exclusive_scan_each_segment", &Sycl_Ragged_Vector::exclusive_scan_each_segment, py::arg("op") = "sum", R"myDelim(
+    Replaces each segment by its exclusive scan with the operation op
+    ("sum", "prod", "min" or "max")
+  )myDelim").def("add_each_segment", &Sycl_Ragged_Vector::add_each_segment, R"myDelim(
+    Adds the value x[s] to each element of segment s
+  )myDelim").def("subtract_each_segment", &Sycl_Ragged_Vector::subtract_each_segment, R"myDelim(
+    Subtracts the value x[s] to each element of segment s
+  )myDelim").def("multiply_each_segment", &Sycl_Ragged_Vector::multiply_each_segment, R"myDelim(
+    Multiplies the value x[s] to each element of segment s
+  )myDelim").def("divide_each_segment", &Sycl_Ragged_Vector::divide_each_segment, R"myDelim(
+    Divides the value x[s] to each element of segment s
+  )myDelim").def("get_values", &Sycl_Ragged_Vector::get_values, R"myDelim(
+    Returns a NumPy array that shares the values without copying
+  )myDelim").def("get_offsets", &Sycl_Ragged_Vector::get_offsets, R"myDelim(
+    Returns a read-only NumPy array that shares the offsets without
+    copying
+  )myDelim");
+
+  py::class_<Sycl_Bit_Vector>(m, "sycl_bit_vector", py::buffer_protocol()).def(py::init<size_t>(), R"myDelim(
+    Initialize a packed boolean vector of 'SIZE' cleared bits
+
+    Parameters
+    ----------
+    SIZE
+  )myDelim").def(py::init<py::array_t<bool, py::array::c_style>>(), py::arg("values").noconvert(), R"myDelim(
+    Initialize a packed boolean vector from a NumPy bool array
+  )myDelim").def_buffer(&Sycl_Bit_Vector::get_buffer_info).def("__len__", &Sycl_Bit_Vector::size, R"myDelim(
+    Returns the number of bits
+  )myDelim").def("count", &Sycl_Bit_Vector::count, R"myDelim(
+    Returns the number of set bits
+  )myDelim").def("__and__", &Sycl_Bit_Vector::logical_and, py::is_operator(), R"myDelim(
+    Returns the element-wise AND with another bit vector
+  )myDelim").def("__or__", &Sycl_Bit_Vector::logical_or, py::is_operator(), R"myDelim(
+    Returns the element-wise OR with another bit vector
+  )myDelim").def("__xor__", &Sycl_Bit_Vector::logical_xor, py::is_operator(), R"myDelim(
+    Returns the element-wise XOR with another bit vector
+  )myDelim").def("__invert__", &Sycl_Bit_Vector::logical_not, R"myDelim(
+    Returns the element-wise NOT
+  )myDelim").def("to_numpy", &Sycl_Bit_Vector::to_numpy, R"myDelim(
+    Returns the bits as a NumPy bool array
+  )myDelim").def("get_words", &Sycl_Bit_Vector::get_words, R"myDelim(
+    Returns a read-only NumPy uint64 array that shares the packed words
+    without copying, element i is bit i % 64 of word i // 64
+  )myDelim");
+
+  py::class_<Sycl_Checkpoint>(m, "sycl_checkpoint").def("done", &Sycl_Checkpoint::done, R"myDelim(
+    Returns True once the checkpoint is on disk or has failed
+  )myDelim").def("wait", &Sycl_Checkpoint::wait, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Waits for the checkpoint and returns the number of bytes written,
+    raises the error of a failed checkpoint
+  )myDelim");
+
+  py::class_<Sycl_Restore>(m, "sycl_restore").def("done", &Sycl_Restore::done, R"myDelim(
+    Returns True once the vector is loaded or the load has failed
+  )myDelim").def("wait", &Sycl_Restore::wait, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Waits for the load and returns the basic_sycl_vector, raises the error
+    of a failed load. The vector is returned by the first call only
   )myDelim");
-}
\ No newline at end of file
+
+  py::class_<Sycl_Mapped_Vector>(m, "sycl_mapped_vector").def(py::init<const std::string&, bool, size_t>(),
+                                                             py::arg("path"), py::arg("writable") = true,
+                                                             py::arg("chunk_size") = MAPPED_CHUNK_SIZE, R"myDelim(
+    Map a .npy file of float64 values, or a raw file of native float64
+    values, without reading it. Every operation streams the file through
+    the device 'chunk_size' elements at a time, so the file may be larger
+    than memory, and writes the changed chunks back to the file
+
+    Parameters
+    ----------
+    path
+    writable
+    chunk_size
+  )myDelim").def("size", &Sycl_Mapped_Vector::size, R"myDelim(
+    Returns the number of elements
+  )myDelim").def("chunk_size", &Sycl_Mapped_Vector::chunk_size, R"myDelim(
+    Returns the number of elements streamed through the device at once
+  )myDelim").def("add_each_element", &Sycl_Mapped_Vector::add_each_element, R"myDelim(
+    Adds a specific value x to each element
+  )myDelim").def("subtract_each_element", &Sycl_Mapped_Vector::subtract_each_element, R"myDelim(
+    Subtracts a specific value x to each element
+  )myDelim").def("multiply_each_element", &Sycl_Mapped_Vector::multiply_each_element, R"myDelim(
+    Multiplies a specific value x to each element
+  )myDelim").def("divide_each_element", &Sycl_Mapped_Vector::divide_each_element, R"myDelim(
+    Divides a specific value x to each element
+  )myDelim").def("apply_batch", py::overload_cast<const std::vector<int>&, const std::vector<double>&>(&Sycl_Mapped_Vector::apply_batch), R"myDelim(
+    Applies a chain of operations (op codes paired with scalars) to each
+    element, one kernel per chunk
+  )myDelim").def("apply_batch", py::overload_cast<const std::string&>(&Sycl_Mapped_Vector::apply_batch), R"myDelim(
+    Applies a chain of operations written as an op string such as
+    "+2 *3.5 /4" to each element, one kernel per chunk
+  )myDelim").def("sum", &Sycl_Mapped_Vector::sum, R"myDelim(
+    Returns the sum of the elements, reduced in a fixed order so the
+    result is reproducible
+  )myDelim").def("min", &Sycl_Mapped_Vector::min, R"myDelim(
+    Returns the minimum of the elements
+  )myDelim").def("max", &Sycl_Mapped_Vector::max, R"myDelim(
+    Returns the maximum of the elements
+  )myDelim").def("flush", &Sycl_Mapped_Vector::flush, R"myDelim(
+    Writes the changed pages back to the file and waits for the disk
+  )myDelim").def("get_array", &Sycl_Mapped_Vector::get_array, R"myDelim(
+    Returns a NumPy array that views the mapped file without copying
+  )myDelim");
+
+  py::class_<Sycl_Stream>(m, "sycl_stream").def(py::init<const std::string&, size_t, size_t, double, double, bool>(),
+                                               py::arg("ops") = "", py::arg("capacity") = STREAM_CAPACITY,
+                                               py::arg("bins") = 0, py::arg("lo") = 0.0, py::arg("hi") = 1.0,
+                                               py::arg("log_scale") = false, R"myDelim(
+    Streaming pipeline that runs each pushed chunk through an op chain on
+    a worker thread and keeps the running count, sum, minimum, maximum and
+    histogram of the results. Up to 'capacity' chunks wait in the queue,
+    pushing into a full queue blocks so producers cannot outrun the device
+
+    Parameters
+    ----------
+    ops
+      Op string such as "+2 *3.5 log", applied to every chunk
+    capacity
+      Maximum number of queued chunks
+    bins
+      Number of histogram bins over [lo, hi], no histogram when 0
+    lo
+    hi
+    log_scale
+      Log spaced bins
+  )myDelim").def("push", &Sycl_Stream::push, py::arg("values"), R"myDelim(
+    Queues a copy of a chunk, waiting with the GIL released while the
+    queue is full. Raises the error of a failed chunk
+  )myDelim").def("try_push", &Sycl_Stream::try_push, py::arg("values"), R"myDelim(
+    Queues a copy of a chunk unless the queue is full, returns whether the
+    chunk was queued
+  )myDelim").def("consume", &Sycl_Stream::consume, py::arg("chunks"), R"myDelim(
+    Pushes every chunk of an iterable such as a generator, so the next
+    chunk is produced while the device works on the previous ones. Returns
+    the number of chunks
+  )myDelim").def("pending", &Sycl_Stream::pending, R"myDelim(
+    Returns the number of chunks queued or being processed, at most
+    capacity + 2 since two chunks stay on the device
+  )myDelim").def("capacity", &Sycl_Stream::capacity, R"myDelim(
+    Returns the maximum number of queued chunks
+  )myDelim").def("flush", &Sycl_Stream::flush, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Waits until every pushed chunk is processed, raises the error of a
+    failed chunk
+  )myDelim").def("count", &Sycl_Stream::count, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Returns the number of elements processed, after a flush
+  )myDelim").def("sum", &Sycl_Stream::sum, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Returns the sum of the processed elements, after a flush
+  )myDelim").def("min", &Sycl_Stream::min, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Returns the minimum of the processed elements, after a flush
+  )myDelim").def("max", &Sycl_Stream::max, py::call_guard<py::gil_scoped_release>(), R"myDelim(
+    Returns the maximum of the processed elements, after a flush
+  )myDelim").def("histogram", &Sycl_Stream::histogram, R"myDelim(
+    Returns the histogram counts of the processed elements, after a flush
+  )myDelim");
+
+  py::class_<Sycl_Ring_Vector>(m, "sycl_ring_vector").def(py::init<size_t>(), py::arg("capacity"), R"myDelim(
+    Fixed capacity window over the last 'capacity' appended values. The
+    sum, mean, variance, minimum and maximum are updated on every append
+    at a cost proportional to the number of appended values, without
+    rescanning the window
+
+    Parameters
+    ----------
+    capacity
+  )myDelim").def("size", &Sycl_Ring_Vector::size, R"myDelim(
+    Returns the number of values in the window
+  )myDelim").def("capacity", &Sycl_Ring_Vector::capacity, R"myDelim(
+    Returns the maximum number of values in the window
+  )myDelim").def("append", &Sycl_Ring_Vector::append, py::arg("values"), R"myDelim(
+    Appends values, evicting the oldest ones once the window is full
+  )myDelim").def("clear", &Sycl_Ring_Vector::clear, R"myDelim(
+    Empties the window
+  )myDelim").def("sum", &Sycl_Ring_Vector::sum, R"myDelim(
+    Returns the sum of the window
+  )myDelim").def("mean", &Sycl_Ring_Vector::mean, R"myDelim(
+    Returns the mean of the window, nan when empty
+  )myDelim").def("variance", &Sycl_Ring_Vector::variance, R"myDelim(
+    Returns the population variance of the window, nan when empty
+  )myDelim").def("min", &Sycl_Ring_Vector::min, R"myDelim(
+    Returns the minimum of the window
+  )myDelim").def("max", &Sycl_Ring_Vector::max, R"myDelim(
+    Returns the maximum of the window
+  )myDelim").def("get_array", &Sycl_Ring_Vector::get_array, R"myDelim(
+    Returns a copy of the window as a NumPy array, oldest value first
+  )myDelim");
+}
@@ -0,0 +1,48 @@
+#ifndef BIT_MASK_CPP
+#define BIT_MASK_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the layout of packed bit masks, where element i
+//         is bit i % 64 of the 64 bit word i / 64
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Bit Mask
+/// \brief    Packed masks with one bit per vector element
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of mask bits in each word
+constexpr size_t MASK_WORD_BITS = 64;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the number of words that hold a mask of SIZE bits
+inline size_t mask_words(size_t SIZE){
+  return (SIZE + MASK_WORD_BITS - 1)/MASK_WORD_BITS;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Checks that a mask of N_WORDS words covers exactly SIZE bits
+inline void check_mask_words(size_t N_WORDS, size_t SIZE){
+  if(N_WORDS != mask_words(SIZE)){
+    throw std::invalid_argument("mask needs " + std::to_string(mask_words(SIZE))
+                                + " words for " + std::to_string(SIZE) + " elements");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns bit i of a packed mask, usable inside sycl kernels
+template<typename Words_type>
+bool mask_bit(const Words_type& words, size_t i){
+  return (words[i/MASK_WORD_BITS] >> (i % MASK_WORD_BITS)) & uint64_t(1);
+}
+
+/// @}
+// end "Bit Mask" doxygen group
+
+#endif //#ifndef BIT_MASK_CPP
@@ -0,0 +1,354 @@
+#ifndef BIT_VECTOR_CPP
+#define BIT_VECTOR_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a packed boolean vector with one bit per
+//         element, used as a mask by the vector classes
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Shared storage, packed masks, comparison predicates and launches
+#include "vector_storage.cpp"
+#include "bit_mask.cpp"
+#include "vector_predicates.cpp"
+#include "scan_kernels.cpp"
+#include "kernel_ranges.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Bit Vector
+/// \brief    Creates a packed sycl based boolean vector
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Holds one bit per element in 64 bit words, the padding bits of
+///        the last word are always zero
+
+class Sycl_Bit_Vector{
+  friend class Basic_Sycl_Vector;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Selected device
+  sycl::queue Q;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bits
+  size_t SIZE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Packed bits, shared with the NumPy arrays returned by get_words
+  std::shared_ptr<uint64_t> WORDS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns a new bit vector with op(word, other word) applied to
+  ///        each pair of words
+  template<typename Op_type>
+  Sycl_Bit_Vector combine(const Sycl_Bit_Vector& other, Op_type op) const;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of bits
+    size_t size() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of set bits
+    size_t count() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the element-wise AND with another bit vector
+    Sycl_Bit_Vector logical_and(const Sycl_Bit_Vector& other) const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the element-wise OR with another bit vector
+    Sycl_Bit_Vector logical_or(const Sycl_Bit_Vector& other) const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the element-wise XOR with another bit vector
+    Sycl_Bit_Vector logical_xor(const Sycl_Bit_Vector& other) const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the element-wise NOT
+    Sycl_Bit_Vector logical_not() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the bits as a NumPy bool array
+    py::array_t<bool> to_numpy() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a read-only NumPy uint64 array that shares the packed
+    ///        words
+    py::array_t<uint64_t> get_words() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the packed words read-only for the buffer protocol
+    py::buffer_info get_buffer_info() const;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that initializes SIZE cleared bits
+    Sycl_Bit_Vector(size_t SIZE_in): SIZE(SIZE_in), WORDS(allocate_storage<uint64_t>(mask_words(SIZE))){}
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that packs a NumPy bool array
+    Sycl_Bit_Vector(py::array_t<bool, py::array::c_style> values);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Copy constructor that copies the packed words
+    Sycl_Bit_Vector(const Sycl_Bit_Vector& other):
+      Q(other.Q), SIZE(other.SIZE), WORDS(allocate_storage<uint64_t>(mask_words(other.SIZE))){
+      std::copy(other.WORDS.get(), other.WORDS.get() + mask_words(SIZE), WORDS.get());
+    }
+
+    Sycl_Bit_Vector(Sycl_Bit_Vector&&) = default;
+    Sycl_Bit_Vector& operator=(Sycl_Bit_Vector&&) = default;
+};
+
+/// @}
+// end "Sycl Bit Vector" doxygen group
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector::Sycl_Bit_Vector(py::array_t<bool, py::array::c_style> values):
+  SIZE(values.size()), WORDS(allocate_storage<uint64_t>(mask_words(values.size()))){
+  const size_t N_WORDS = mask_words(SIZE);
+  if(N_WORDS == 0){
+    return;
+  }
+
+  // creating a sycl scope
+  {
+    // creating buffers for the bools and the words
+    sycl::buffer<bool> value_buffer{values.data(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> word_buffer{WORDS.get(), sycl::range<1>{N_WORDS}};
+    const size_t N = SIZE;
+
+    // executing a sycl kernel that packs 64 bools per work-item
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor value_access{value_buffer, h, sycl::read_only};
+      sycl::accessor word_access{word_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, N_WORDS, [=](size_t idx){
+        const size_t begin = idx*MASK_WORD_BITS;
+        const size_t end   = sycl::min(begin + MASK_WORD_BITS, N);
+        uint64_t word = 0;
+        for(size_t i = begin; i < end; ++i){
+          word |= static_cast<uint64_t>(value_access[i]) << (i - begin);
+        }
+        word_access[idx] = word;
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Op_type>
+Sycl_Bit_Vector Sycl_Bit_Vector::combine(const Sycl_Bit_Vector& other, Op_type op) const{
+  if(other.SIZE != SIZE){
+    throw std::invalid_argument("bit vector sizes differ");
+  }
+
+  const size_t N_WORDS = mask_words(SIZE);
+  Sycl_Bit_Vector result(SIZE);
+  result.Q = Q;
+
+  if(N_WORDS > 0){
+    // creating buffers for the inputs and the result
+    sycl::buffer<uint64_t> a_buffer{WORDS.get(), sycl::range<1>{N_WORDS}};
+    sycl::buffer<uint64_t> b_buffer{other.WORDS.get(), sycl::range<1>{N_WORDS}};
+    sycl::buffer<uint64_t> result_buffer{result.WORDS.get(), sycl::range<1>{N_WORDS}};
+
+    // executing a sycl kernel on whole words
+    result.Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor a_access{a_buffer, h, sycl::read_only};
+      sycl::accessor b_access{b_buffer, h, sycl::read_only};
+      sycl::accessor result_access{result_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, N_WORDS, [=](size_t idx){
+        result_access[idx] = op(a_access[idx], b_access[idx]);
+      });
+    });
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Bit_Vector::size() const{
+  return SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Bit_Vector::count() const{
+  const size_t N_WORDS = mask_words(SIZE);
+  if(N_WORDS == 0){
+    return 0;
+  }
+
+  sycl::queue Q_count = Q;
+  const size_t L       = scan_work_group_size(Q_count);
+  const size_t N_GROUPS = (N_WORDS + L - 1)/L;
+
+  uint64_t count = 0;
+  // creating a sycl scope
+  {
+    // creating buffers for the words and the count
+    sycl::buffer<uint64_t> word_buffer{WORDS.get(), sycl::range<1>{N_WORDS}};
+    sycl::buffer<uint64_t> count_buffer{&count, sycl::range<1>{1}};
+
+    // executing a sycl kernel that counts one word per work-item
+    Q_count.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor word_access{word_buffer, h, sycl::read_only};
+      sycl::accessor count_access{count_buffer, h};
+      h.parallel_for(sycl::nd_range<1>{N_GROUPS*L, L}, [=](sycl::nd_item<1> item){
+        const size_t i = item.get_global_id(0);
+        const uint64_t bits = i < N_WORDS ? sycl::popcount(word_access[i]) : 0;
+
+        // one device atomic per work-group
+        const uint64_t group_bits = sycl::reduce_over_group(item.get_group(), bits, sycl::plus<uint64_t>());
+        if(item.get_local_id(0) == 0 && group_bits != 0){
+          sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                           sycl::access::address_space::global_space> counter{count_access[0]};
+          counter.fetch_add(group_bits);
+        }
+      });
+    });
+  }
+
+  return static_cast<size_t>(count);
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector Sycl_Bit_Vector::logical_and(const Sycl_Bit_Vector& other) const{
+  return combine(other, [](uint64_t a, uint64_t b){ return a & b; });
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector Sycl_Bit_Vector::logical_or(const Sycl_Bit_Vector& other) const{
+  return combine(other, [](uint64_t a, uint64_t b){ return a | b; });
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector Sycl_Bit_Vector::logical_xor(const Sycl_Bit_Vector& other) const{
+  return combine(other, [](uint64_t a, uint64_t b){ return a ^ b; });
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector Sycl_Bit_Vector::logical_not() const{
+  // keeping the padding bits of the last word cleared
+  const size_t N_WORDS  = mask_words(SIZE);
+  const size_t LAST     = N_WORDS - 1;
+  const size_t TAIL     = SIZE % MASK_WORD_BITS;
+  const uint64_t TAIL_MASK = TAIL == 0 ? ~uint64_t(0) : (uint64_t(1) << TAIL) - 1;
+
+  Sycl_Bit_Vector result(*this);
+  if(N_WORDS > 0){
+    // creating a buffer for the words
+    sycl::buffer<uint64_t> word_buffer{result.WORDS.get(), sycl::range<1>{N_WORDS}};
+
+    // executing a sycl kernel on whole words
+    result.Q.submit([&](sycl::handler &h){
+      // creating a device accessor
+      sycl::accessor word_access{word_buffer, h};
+      parallel_for_each(h, N_WORDS, [=](size_t idx){
+        const uint64_t word = ~word_access[idx];
+        word_access[idx] = idx == LAST ? (word & TAIL_MASK) : word;
+      });
+    });
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<bool> Sycl_Bit_Vector::to_numpy() const{
+  py::array_t<bool> values(SIZE);
+  const size_t N_WORDS = mask_words(SIZE);
+
+  if(N_WORDS > 0){
+    sycl::queue Q_unpack = Q;
+
+    // creating buffers for the words and the bools
+    sycl::buffer<uint64_t> word_buffer{WORDS.get(), sycl::range<1>{N_WORDS}};
+    sycl::buffer<bool> value_buffer{values.mutable_data(), sycl::range<1>{SIZE}};
+    const size_t N = SIZE;
+
+    // executing a sycl kernel that unpacks 64 bools per work-item
+    Q_unpack.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor word_access{word_buffer, h, sycl::read_only};
+      sycl::accessor value_access{value_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, N_WORDS, [=](size_t idx){
+        const uint64_t word = word_access[idx];
+        const size_t begin  = idx*MASK_WORD_BITS;
+        const size_t end    = sycl::min(begin + MASK_WORD_BITS, N);
+        for(size_t i = begin; i < end; ++i){
+          value_access[i] = (word >> (i - begin)) & uint64_t(1);
+        }
+      });
+    });
+  }
+
+  return values;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<uint64_t> Sycl_Bit_Vector::get_words() const{
+  py::array_t<uint64_t> words = share_storage(WORDS, mask_words(SIZE));
+  // count and the queries rely on the padding bits past SIZE staying clear
+  words.attr("setflags")(py::arg("write") = false);
+  return words;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::buffer_info Sycl_Bit_Vector::get_buffer_info() const{
+  return py::buffer_info(WORDS.get(), sizeof(uint64_t), py::format_descriptor<uint64_t>::format(),
+                         1, {static_cast<py::ssize_t>(mask_words(SIZE))}, {static_cast<py::ssize_t>(sizeof(uint64_t))},
+                         true);
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Bit_Vector Basic_Sycl_Vector::compare(const std::string& op, double x, double y){
+  const Vector_Predicate predicate = make_vector_predicate(op, x, y);
+  const size_t N_WORDS = mask_words(SIZE);
+
+  Sycl_Bit_Vector result(SIZE);
+  result.Q = Q;
+
+  if(N_WORDS > 0){
+    // creating buffers for the vector and the words
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<uint64_t> word_buffer{result.WORDS.get(), sycl::range<1>{N_WORDS}};
+    const size_t N = SIZE;
+
+    // executing a sycl kernel that builds one word per work-item, so no
+    // atomics are needed
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor word_access{word_buffer, h, sycl::write_only, sycl::no_init};
+      parallel_for_each(h, N_WORDS, [=](size_t idx){
+        const size_t begin = idx*MASK_WORD_BITS;
+        const size_t end   = sycl::min(begin + MASK_WORD_BITS, N);
+        uint64_t word = 0;
+        for(size_t i = begin; i < end; ++i){
+          word |= static_cast<uint64_t>(predicate(A_access[i])) << (i - begin);
+        }
+        word_access[idx] = word;
+      });
+    });
+  }
+
+  return result;
+}
+
+#endif //#ifndef BIT_VECTOR_CPP
@@ -0,0 +1,148 @@
+#ifndef CHECKPOINT_CPP
+#define CHECKPOINT_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the handles returned by the asynchronous
+//         checkpoint and restore of Basic_Sycl_Vector
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <future>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Background thread, file formats
+#include "background_io.cpp"
+#include "chunked_format.cpp"
+#include "vector_io.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Checkpoints
+/// \brief    Asynchronous checkpoint and restore
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Handle of a checkpoint being written in the background
+
+class Sycl_Checkpoint{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bytes written, available once the file is complete
+  std::shared_future<size_t> BYTES;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns true once the checkpoint is on disk or has failed
+    bool done(){
+      return BYTES.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Waits for the checkpoint and returns the number of bytes
+    ///        written, rethrows the error of a failed checkpoint
+    size_t wait(){
+      return BYTES.get();
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that takes the future of the background job
+    Sycl_Checkpoint(std::future<size_t> bytes): BYTES(bytes.share()){}
+};
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Handle of a vector being loaded in the background
+
+class Sycl_Restore{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Loaded vector, moved out by the first wait
+  std::future<Basic_Sycl_Vector> VECTOR;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns true once the vector is loaded or the load failed
+    bool done(){
+      return !VECTOR.valid() || VECTOR.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Waits for the load and returns the vector, rethrows the error
+    ///        of a failed load
+    Basic_Sycl_Vector wait(){
+      if(!VECTOR.valid()){
+        throw std::runtime_error("the restored vector was already returned by wait");
+      }
+      return VECTOR.get();
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that takes the future of the background job
+    Sycl_Restore(std::future<Basic_Sycl_Vector> vector): VECTOR(std::move(vector)){}
+};
+
+/// @}
+// end "Checkpoints" doxygen group
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Checkpoint Basic_Sycl_Vector::checkpoint(const std::string& path, const std::string& codec){
+  // failing now rather than in the background for unknown codecs
+  const uint32_t CODEC = codec.empty() ? VECTOR_CODEC_RAW : vector_codec_from_name(codec);
+
+  // the snapshot is taken before returning, so later changes to the
+  // vector do not leak into the checkpoint
+  auto snapshot = std::make_shared<Basic_Sycl_Vector>(*this);
+
+  return Sycl_Checkpoint(background_io().submit([snapshot, path, codec, CODEC](){
+    // writing next to the target and renaming, so a crash mid-write
+    // leaves the previous checkpoint intact, the .npz suffix stays last
+    // because save picks the format from it
+    const bool NPZ = path.size() >= 4 && path.compare(path.size() - 4, 4, ".npz") == 0;
+    const std::string partial = NPZ ? path.substr(0, path.size() - 4) + ".partial.npz" : path + ".partial";
+    size_t BYTES = 0;
+    try{
+      if(codec.empty()){
+        snapshot->save(partial, false);
+      }
+      else{
+        write_chunked(partial, snapshot->A.get(), snapshot->SIZE, CODEC, CHUNKED_CHUNK_SIZE);
+      }
+
+      // the data must reach the disk before the rename does
+      File_Descriptor file(partial, O_RDONLY);
+      BYTES = file.size();
+      if(fsync(file.get()) != 0){
+        throw std::runtime_error("cannot sync " + partial + ": " + std::strerror(errno));
+      }
+      if(std::rename(partial.c_str(), path.c_str()) != 0){
+        throw std::runtime_error("cannot rename " + partial + " to " + path + ": " + std::strerror(errno));
+      }
+    }
+    catch(...){
+      unlink(partial.c_str());
+      throw;
+    }
+
+    // syncing the directory makes the rename itself durable
+    const size_t SLASH = path.find_last_of('/');
+    const std::string directory = SLASH == std::string::npos ? "." : SLASH == 0 ? "/" : path.substr(0, SLASH);
+    File_Descriptor parent(directory, O_RDONLY | O_DIRECTORY);
+    if(fsync(parent.get()) != 0){
+      throw std::runtime_error("cannot sync " + directory + ": " + std::strerror(errno));
+    }
+    return BYTES;
+  }));
+}
+
+////////////////////////////////////////////////////////////////////////
+Sycl_Restore Basic_Sycl_Vector::restore(const std::string& path){
+  return Sycl_Restore(background_io().submit([path](){
+    if(is_chunked(path)){
+      return load_compressed(path, 0, std::numeric_limits<size_t>::max());
+    }
+    return load(path, false, false, "");
+  }));
+}
+
+#endif //#ifndef CHECKPOINT_CPP
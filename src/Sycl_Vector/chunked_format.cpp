@@ -0,0 +1,230 @@
+#ifndef CHUNKED_FORMAT_CPP
+#define CHUNKED_FORMAT_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a chunked, compressed file format for float64
+//         vectors, whose chunks are coded in parallel and can be read back
+//         on their own
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+// File I/O and chunk codecs
+#include "vector_io.cpp"
+#include "vector_codecs.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Chunked Format
+/// \brief    Chunked vector files with a chunk index
+/// @{
+///////////////////////////////////////////////////////////////////////////
+///
+/// Layout, all integers little endian:
+///   header  magic "SYCLVCK\0", version u32, codec u32, SIZE u64,
+///           CHUNK_SIZE u64, index offset u64
+///   chunks  the coded chunks, back to back
+///   index   per chunk: offset u64, bytes u64, codec u32, reserved u32
+///
+/// The index is written last, so chunks are streamed out as they are
+/// coded. Each chunk records its own codec because chunks that do not
+/// shrink are stored raw.
+
+constexpr char CHUNKED_MAGIC[8]          = {'S', 'Y', 'C', 'L', 'V', 'C', 'K', '\0'};
+constexpr uint32_t CHUNKED_VERSION       = 1;
+constexpr size_t CHUNKED_HEADER_BYTES    = 40;
+constexpr size_t CHUNKED_ENTRY_BYTES     = 24;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Default number of elements per chunk (8 MiB of float64), small
+///        enough for cheap sub-range reads and large enough for the
+///        compressors
+constexpr size_t CHUNKED_CHUNK_SIZE = size_t(1) << 20;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Index entry of a chunk
+struct Chunk_Entry{
+  uint64_t offset;
+  uint64_t bytes;
+  uint32_t codec;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Opened chunked file with its header and index
+struct Chunked_File{
+  File_Descriptor file;
+  uint32_t codec;
+  size_t SIZE;
+  size_t CHUNK_SIZE;
+  std::vector<Chunk_Entry> index;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns the number of elements of chunk c
+  size_t chunk_elements(size_t c) const{
+    return std::min(CHUNK_SIZE, SIZE - c*CHUNK_SIZE);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Writes SIZE values to path in chunks of CHUNK_SIZE elements
+///        coded with codec
+///
+/// The chunks are coded in rounds of one chunk per core, then each round
+/// is written with one pwrite per chunk at consecutive offsets.
+inline void write_chunked(const std::string& path, const double* values, size_t SIZE,
+                          uint32_t codec, size_t CHUNK_SIZE){
+  if(CHUNK_SIZE == 0){
+    throw std::invalid_argument("chunk_size must be positive");
+  }
+  if(!vector_codec_available(codec)){
+    throw std::invalid_argument("codec " + std::to_string(codec) + " is not included in this build");
+  }
+
+  File_Descriptor file(path, O_WRONLY | O_CREAT | O_TRUNC);
+  const size_t N_CHUNKS = (SIZE + CHUNK_SIZE - 1)/CHUNK_SIZE;
+  const size_t ROUND    = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<Chunk_Entry> index(N_CHUNKS);
+  size_t offset = CHUNKED_HEADER_BYTES;
+  std::vector<std::string> coded(ROUND);
+  for(size_t first = 0; first < N_CHUNKS; first += ROUND){
+    const size_t N_ROUND = std::min(ROUND, N_CHUNKS - first);
+
+    run_parallel(N_ROUND, [&](size_t k){
+      const size_t c = first + k;
+      const size_t N = std::min(CHUNK_SIZE, SIZE - c*CHUNK_SIZE);
+      coded[k] = encode_chunk(codec, values + c*CHUNK_SIZE, N);
+      index[c].codec = codec;
+      // keeping chunks that do not compress raw, which also bounds the file
+      if(coded[k].size() >= N*sizeof(double)){
+        coded[k] = encode_chunk(VECTOR_CODEC_RAW, values + c*CHUNK_SIZE, N);
+        index[c].codec = VECTOR_CODEC_RAW;
+      }
+    });
+
+    for(size_t k = 0; k < N_ROUND; ++k){
+      index[first + k].offset = offset;
+      index[first + k].bytes  = coded[k].size();
+      offset += coded[k].size();
+    }
+
+    run_parallel(N_ROUND, [&](size_t k){
+      const int error = write_exact(file.get(), coded[k].data(), coded[k].size(), index[first + k].offset);
+      if(error != 0){
+        throw std::runtime_error("cannot write " + path + ": " + std::strerror(error));
+      }
+    });
+  }
+
+  std::string tail;
+  for(const Chunk_Entry& entry : index){
+    put_le<uint64_t>(tail, entry.offset);
+    put_le<uint64_t>(tail, entry.bytes);
+    put_le<uint32_t>(tail, entry.codec);
+    put_le<uint32_t>(tail, 0);
+  }
+
+  std::string header(CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC));
+  put_le<uint32_t>(header, CHUNKED_VERSION);
+  put_le<uint32_t>(header, codec);
+  put_le<uint64_t>(header, SIZE);
+  put_le<uint64_t>(header, CHUNK_SIZE);
+  put_le<uint64_t>(header, offset);
+
+  int error = write_exact(file.get(), tail.data(), tail.size(), offset);
+  if(error == 0){
+    error = write_exact(file.get(), header.data(), header.size(), 0);
+  }
+  if(error != 0){
+    throw std::runtime_error("cannot write " + path + ": " + std::strerror(error));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns true when the file at path starts with the chunked magic
+inline bool is_chunked(const std::string& path){
+  File_Descriptor file(path, O_RDONLY);
+  char magic[sizeof(CHUNKED_MAGIC)];
+  return read_exact(file.get(), magic, sizeof(magic), 0) == 0
+         && std::memcmp(magic, CHUNKED_MAGIC, sizeof(magic)) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Opens a chunked file and reads its header and index
+inline Chunked_File open_chunked(const std::string& path){
+  Chunked_File chunked{File_Descriptor(path, O_RDONLY), 0, 0, 0, {}};
+  const size_t FILE_BYTES = chunked.file.size();
+  if(FILE_BYTES < CHUNKED_HEADER_BYTES){
+    throw std::invalid_argument(path + " is not a chunked vector file");
+  }
+
+  const std::string header = read_string(chunked.file.get(), CHUNKED_HEADER_BYTES, 0);
+  if(std::memcmp(header.data(), CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC)) != 0){
+    throw std::invalid_argument(path + " is not a chunked vector file");
+  }
+  if(get_le<uint32_t>(header.data() + 8) != CHUNKED_VERSION){
+    throw std::invalid_argument(path + " has an unsupported chunked format version");
+  }
+  chunked.codec      = get_le<uint32_t>(header.data() + 12);
+  chunked.SIZE       = get_le<uint64_t>(header.data() + 16);
+  chunked.CHUNK_SIZE = get_le<uint64_t>(header.data() + 24);
+  const size_t INDEX_OFFSET = get_le<uint64_t>(header.data() + 32);
+
+  const size_t N_CHUNKS = chunked.CHUNK_SIZE == 0 ? 0 : (chunked.SIZE + chunked.CHUNK_SIZE - 1)/chunked.CHUNK_SIZE;
+  if((chunked.CHUNK_SIZE == 0 && chunked.SIZE > 0)
+     || INDEX_OFFSET > FILE_BYTES || (FILE_BYTES - INDEX_OFFSET)/CHUNKED_ENTRY_BYTES < N_CHUNKS){
+    throw std::invalid_argument(path + " has a corrupt chunk index");
+  }
+
+  const std::string index = read_string(chunked.file.get(), N_CHUNKS*CHUNKED_ENTRY_BYTES, INDEX_OFFSET);
+  chunked.index.resize(N_CHUNKS);
+  for(size_t c = 0; c < N_CHUNKS; ++c){
+    const char* entry = index.data() + c*CHUNKED_ENTRY_BYTES;
+    chunked.index[c] = Chunk_Entry{get_le<uint64_t>(entry), get_le<uint64_t>(entry + 8), get_le<uint32_t>(entry + 16)};
+    if(chunked.index[c].offset + chunked.index[c].bytes > INDEX_OFFSET){
+      throw std::invalid_argument(path + " has a corrupt chunk index");
+    }
+  }
+  return chunked;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reads the elements [begin, end) of a chunked file into values,
+///        reading and decoding only the chunks that overlap the range, one
+///        chunk per task
+inline void read_chunked(const Chunked_File& chunked, size_t begin, size_t end, double* values){
+  if(begin >= end){
+    return;
+  }
+
+  const size_t FIRST = begin/chunked.CHUNK_SIZE;
+  const size_t LAST  = (end - 1)/chunked.CHUNK_SIZE;
+  run_parallel(LAST - FIRST + 1, [&](size_t k){
+    const size_t c     = FIRST + k;
+    const size_t N     = chunked.chunk_elements(c);
+    const size_t START = c*chunked.CHUNK_SIZE;
+    const Chunk_Entry& entry = chunked.index[c];
+    const std::string bytes = read_string(chunked.file.get(), entry.bytes, entry.offset);
+
+    // chunks inside the range are decoded in place
+    const size_t from = std::max(begin, START);
+    const size_t to   = std::min(end, START + N);
+    if(from == START && to == START + N){
+      decode_chunk(entry.codec, bytes.data(), bytes.size(), values + (START - begin), N);
+    }
+    else{
+      std::vector<double> chunk(N);
+      decode_chunk(entry.codec, bytes.data(), bytes.size(), chunk.data(), N);
+      std::copy(chunk.begin() + (from - START), chunk.begin() + (to - START), values + (from - begin));
+    }
+  });
+}
+
+/// @}
+// end "Chunked Format" doxygen group
+
+#endif //#ifndef CHUNKED_FORMAT_CPP
@@ -0,0 +1,209 @@
+#ifndef HISTOGRAM_KERNELS_CPP
+#define HISTOGRAM_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a histogram kernel with work-group privatized
+//         bins for uniform, logarithmic and explicit edge binning
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Work-group sizes
+#include "scan_kernels.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Histogram Kernels
+/// \brief    Histograms with low contention on skewed data
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Codes of the binning schemes
+enum Histogram_Scale : int {
+  HISTOGRAM_LINEAR = 0,
+  HISTOGRAM_LOG    = 1,
+  HISTOGRAM_EDGES  = 2
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of elements visited by each work-item
+constexpr size_t HISTOGRAM_ITEMS_PER_WORK_ITEM = 16;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief A binning scheme, trivially copyable so that it can be captured
+///        by sycl kernels
+///
+/// For the linear and log scales lo and hi are the outer edges (in log
+/// space for the log scale) and scale is N_BINS/(hi - lo). For explicit
+/// edges the N_BINS + 1 edges live in a separate buffer.
+struct Histogram_Bins{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Binning scheme code
+  int kind;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bins
+  size_t N_BINS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Lower edge of the first bin
+  double lo;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Upper edge of the last bin
+  double hi;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Bins per unit between lo and hi
+  double scale;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Creates equal width bins over [lo, hi], or equal width bins in
+///        log space when log_scale is set
+inline Histogram_Bins make_histogram_bins(size_t N_BINS, double lo, double hi, bool log_scale){
+  if(N_BINS == 0){
+    throw std::invalid_argument("a histogram needs at least one bin");
+  }
+  if(!(lo < hi) || !std::isfinite(lo) || !std::isfinite(hi)){
+    throw std::invalid_argument("histogram range must be finite with lo < hi");
+  }
+  if(log_scale){
+    if(!(lo > 0.0)){
+      throw std::invalid_argument("log scale histogram range must be positive");
+    }
+    lo = std::log(lo);
+    hi = std::log(hi);
+  }
+  return Histogram_Bins{log_scale ? HISTOGRAM_LOG : HISTOGRAM_LINEAR, N_BINS, lo, hi,
+                        static_cast<double>(N_BINS)/(hi - lo)};
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Creates bins from N_BINS + 1 increasing edges
+inline Histogram_Bins make_histogram_bins(const std::vector<double>& edges){
+  if(edges.size() < 2){
+    throw std::invalid_argument("a histogram needs at least two edges");
+  }
+  for(size_t i = 0; i < edges.size(); ++i){
+    if(!std::isfinite(edges[i]) || (i > 0 && !(edges[i - 1] < edges[i]))){
+      throw std::invalid_argument("histogram edges must be finite and increasing");
+    }
+  }
+  return Histogram_Bins{HISTOGRAM_EDGES, edges.size() - 1, edges.front(), edges.back(), 0.0};
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the bin of a value, or N_BINS when it is outside the
+///        range or NaN, the last bin includes its upper edge
+template<typename Edges_type>
+size_t histogram_bin(const Histogram_Bins& bins, const Edges_type& edges, double value){
+  if(bins.kind == HISTOGRAM_LOG){
+    value = value > 0.0 ? sycl::log(value) : -std::numeric_limits<double>::infinity();
+  }
+  if(!(value >= bins.lo && value <= bins.hi)){
+    return bins.N_BINS;
+  }
+
+  if(bins.kind == HISTOGRAM_EDGES){
+    // finding the last edge that is not above the value
+    size_t first = 0;
+    size_t last  = bins.N_BINS;
+    while(last - first > 1){
+      const size_t middle = (first + last)/2;
+      if(edges[middle] <= value){
+        first = middle;
+      }
+      else{
+        last = middle;
+      }
+    }
+    return first;
+  }
+
+  return sycl::min(static_cast<size_t>((value - bins.lo)*bins.scale), bins.N_BINS - 1);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Adds the histogram of the first N elements of data to counts
+///
+/// Every work-group counts its tile in local bins with work-group scoped
+/// atomics and merges the non-empty bins into counts with one device
+/// atomic each, so heavily skewed data only contends inside a work-group.
+/// When the bins do not fit in half of the local memory the kernel falls
+/// back to device atomics on counts directly.
+inline void histogram_buffer(sycl::queue& Q, sycl::buffer<double>& data, size_t N,
+                             const Histogram_Bins& bins, sycl::buffer<double>& edges,
+                             sycl::buffer<int64_t>& counts){
+  if(N == 0){
+    return;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*HISTOGRAM_ITEMS_PER_WORK_ITEM;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+  const size_t N_BINS  = bins.N_BINS;
+
+  const bool privatized =
+    N_BINS*sizeof(uint32_t) <= Q.get_device().get_info<sycl::info::device::local_mem_size>()/2;
+
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor data_access{data, h, sycl::read_only};
+    sycl::accessor edge_access{edges, h, sycl::read_only};
+    sycl::accessor count_access{counts, h};
+    sycl::local_accessor<uint32_t> local_bins{sycl::range<1>{privatized ? N_BINS : 1}, h};
+    h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+      const auto group   = item.get_group();
+      const size_t local = item.get_local_id(0);
+      const size_t begin = item.get_group(0)*TILE;
+      const size_t end   = sycl::min(begin + TILE, N);
+
+      if(privatized){
+        for(size_t b = local; b < N_BINS; b += L){
+          local_bins[b] = 0;
+        }
+        sycl::group_barrier(group);
+      }
+
+      for(size_t i = begin + local; i < end; i += L){
+        const size_t b = histogram_bin(bins, edge_access, data_access[i]);
+        if(b == N_BINS){
+          continue;
+        }
+        if(privatized){
+          sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed, sycl::memory_scope::work_group,
+                           sycl::access::address_space::local_space> bin{local_bins[b]};
+          bin.fetch_add(1u);
+        }
+        else{
+          sycl::atomic_ref<int64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                           sycl::access::address_space::global_space> bin{count_access[b]};
+          bin.fetch_add(int64_t(1));
+        }
+      }
+
+      if(privatized){
+        sycl::group_barrier(group);
+        for(size_t b = local; b < N_BINS; b += L){
+          if(local_bins[b] != 0){
+            sycl::atomic_ref<int64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                             sycl::access::address_space::global_space> bin{count_access[b]};
+            bin.fetch_add(static_cast<int64_t>(local_bins[b]));
+          }
+        }
+      }
+    });
+  });
+}
+
+/// @}
+// end "Histogram Kernels" doxygen group
+
+#endif //#ifndef HISTOGRAM_KERNELS_CPP
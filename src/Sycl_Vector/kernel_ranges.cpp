@@ -0,0 +1,84 @@
+#ifndef KERNEL_RANGES_CPP
+#define KERNEL_RANGES_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the element-wise kernel launch used by the
+//         vector classes, which keeps 64 bit sizes within backend limits,
+//         and the queue profiling helpers
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Kernel Ranges
+/// \brief    Element-wise launches over 64 bit sizes
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Largest range launched by an element-wise kernel, several
+///        backends limit ranges (or range times work-group size) to 32
+///        bit integers
+#ifndef SYCL_VECTOR_MAX_KERNEL_RANGE
+#define SYCL_VECTOR_MAX_KERNEL_RANGE (size_t(1) << 30)
+#endif
+constexpr size_t MAX_KERNEL_RANGE = SYCL_VECTOR_MAX_KERNEL_RANGE;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Calls f(i) for every i < N in a kernel submitted with h
+///
+/// Up to MAX_KERNEL_RANGE elements this is a plain parallel_for with one
+/// work-item per element. Beyond that every work-item strides over the
+/// elements by the launched range, so sizes of several billion elements
+/// run in one launch without overflowing the backend's range limit.
+template<typename Function_type>
+void parallel_for_each(sycl::handler& h, size_t N, Function_type f){
+  const size_t RANGE = std::min(N, MAX_KERNEL_RANGE);
+  if(RANGE == N){
+    h.parallel_for(sycl::range<1>{N}, [=](sycl::id<1> idx){
+      f(static_cast<size_t>(idx[0]));
+    });
+  }
+  else{
+    h.parallel_for(sycl::range<1>{RANGE}, [=](sycl::id<1> idx){
+      for(size_t i = idx[0]; i < N; i += RANGE){
+        f(i);
+      }
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Recreates Q on the same device, with profiling when enable is
+///        set
+inline void set_queue_profiling(sycl::queue& Q, bool enable){
+  if(enable){
+    Q = sycl::queue{Q.get_device(), sycl::property::queue::enable_profiling{}};
+  }
+  else{
+    Q = sycl::queue{Q.get_device()};
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the time in seconds that the kernel of kernel_event
+///        ran, or nothing when Q was created without profiling
+inline std::optional<double> kernel_event_time(sycl::queue& Q, sycl::event& kernel_event){
+  if(!Q.has_property<sycl::property::queue::enable_profiling>()){
+    return std::nullopt;
+  }
+
+  const auto start = kernel_event.get_profiling_info<sycl::info::event_profiling::command_start>();
+  const auto end   = kernel_event.get_profiling_info<sycl::info::event_profiling::command_end>();
+  return static_cast<double>(end - start)*1.0e-9;
+}
+
+/// @}
+// end "Kernel Ranges" doxygen group
+
+#endif //#ifndef KERNEL_RANGES_CPP
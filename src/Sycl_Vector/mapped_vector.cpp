@@ -0,0 +1,428 @@
+#ifndef MAPPED_VECTOR_CPP
+#define MAPPED_VECTOR_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing an out-of-core vector that maps a raw float64
+//         or .npy file and streams it through the device in chunks
+///////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+// File mappings
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Operation codes, shared storage, launches, reductions and .npy headers
+#include "vector_ops.cpp"
+#include "vector_storage.cpp"
+#include "kernel_ranges.cpp"
+#include "reduce_kernels.cpp"
+#include "npy_format.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Mapped Vector
+/// \brief    Creates a file backed sycl based vector
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Default number of elements streamed through the device at once
+///        (128 MiB of float64)
+constexpr size_t MAPPED_CHUNK_SIZE = size_t(1) << 24;
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Maps a file of float64 values and runs every operation chunk by
+///        chunk, so the vector may be much larger than host or device
+///        memory
+
+class Sycl_Mapped_Vector{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Selected device
+  sycl::queue Q;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Whether the file was opened for writing
+  bool WRITABLE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of elements
+  size_t SIZE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of elements per chunk
+  size_t CHUNK_SIZE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Bytes before the first element, the .npy header if any
+  size_t DATA_OFFSET;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Mapping of the whole file, unmapped with the last reference
+  std::shared_ptr<char> MAP;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns the first element of the mapping
+  double* data();
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Applies advice to the pages that hold the elements in
+  ///        [begin, end)
+  void advise(size_t begin, size_t end, int advice);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Calls f(chunk, begin, N) with a buffer over each chunk of N
+  ///        elements starting at begin, copying the chunks back to the
+  ///        file when write is set
+  template<typename Function_type>
+  void for_each_chunk(bool write, Function_type f);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Reduces the whole file with the operation op
+  template<typename Op_type>
+  double reduce(double identity, Op_type op);
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of elements
+    size_t size();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of elements per chunk
+    size_t chunk_size();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds some value x to each element
+    void add_each_element(double x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Subtracts some value x from each element
+    void subtract_each_element(double x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Multiplies each element by some value x
+    void multiply_each_element(double x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Divides each element by some value x
+    void divide_each_element(double x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations (op codes paired with scalars)
+    ///        to each element, one kernel per chunk
+    void apply_batch(const std::vector<int>& op_codes, const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations written as an op string such
+    ///        as "+2 *3.5 /4" to each element
+    void apply_batch(const std::string& ops);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of the elements
+    double sum();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of the elements
+    double min();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of the elements
+    double max();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Writes the changed pages back to the file and waits for the
+    ///        disk
+    void flush();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a NumPy array that views the mapping without copying,
+    ///        read-only when the file was opened read-only
+    py::array_t<double> get_array();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that maps a .npy file, or a raw file of float64
+    ///        values when it does not start with the .npy magic
+    Sycl_Mapped_Vector(const std::string& path, bool writable = true,
+                       size_t chunk_size = MAPPED_CHUNK_SIZE):
+      WRITABLE(writable), SIZE(0), CHUNK_SIZE(chunk_size), DATA_OFFSET(0){
+      if(CHUNK_SIZE == 0){
+        throw std::invalid_argument("chunk_size must be positive");
+      }
+
+      const int fd = open(path.c_str(), WRITABLE ? O_RDWR : O_RDONLY);
+      if(fd < 0){
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+      }
+      struct stat file_stat;
+      if(fstat(fd, &file_stat) != 0){
+        const int error = errno;
+        close(fd);
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(error));
+      }
+      const size_t FILE_BYTES = static_cast<size_t>(file_stat.st_size);
+      if(FILE_BYTES == 0){
+        close(fd);
+        return;
+      }
+
+      // the mapping stays valid after the descriptor is closed
+      void* map = mmap(nullptr, FILE_BYTES, WRITABLE ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_SHARED, fd, 0);
+      const int error = errno;
+      close(fd);
+      if(map == MAP_FAILED){
+        throw std::runtime_error("cannot map " + path + ": " + std::strerror(error));
+      }
+      MAP = std::shared_ptr<char>(static_cast<char*>(map), [FILE_BYTES](char* p){
+        munmap(p, FILE_BYTES);
+      });
+
+      if(is_npy(MAP.get(), FILE_BYTES)){
+        const Npy_Header header = parse_npy_header(MAP.get(), FILE_BYTES, FILE_BYTES);
+        if(header.data_offset + header.SIZE*sizeof(double) > FILE_BYTES){
+          throw std::invalid_argument(path + " is shorter than its .npy header says");
+        }
+        DATA_OFFSET = header.data_offset;
+        SIZE        = header.SIZE;
+      }
+      else{
+        if(FILE_BYTES % sizeof(double) != 0){
+          throw std::invalid_argument(path + " does not hold a whole number of float64 values");
+        }
+        SIZE = FILE_BYTES/sizeof(double);
+      }
+
+      // every operation reads the file front to back
+      madvise(map, FILE_BYTES, MADV_SEQUENTIAL);
+    }
+};
+
+/// @}
+// end "Sycl Mapped Vector" doxygen group
+
+////////////////////////////////////////////////////////////////////////
+double* Sycl_Mapped_Vector::data(){
+  return reinterpret_cast<double*>(MAP.get() + DATA_OFFSET);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::advise(size_t begin, size_t end, int advice){
+  // madvise and msync need page aligned addresses
+  const size_t PAGE_BYTES = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t first = (DATA_OFFSET + begin*sizeof(double))/PAGE_BYTES*PAGE_BYTES;
+  const size_t last  = DATA_OFFSET + end*sizeof(double);
+  if(advice == MADV_DONTNEED && WRITABLE){
+    // starting the write-back before the pages are dropped from the mapping
+    msync(MAP.get() + first, last - first, MS_ASYNC);
+  }
+  madvise(MAP.get() + first, last - first, advice);
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Function_type>
+void Sycl_Mapped_Vector::for_each_chunk(bool write, Function_type f){
+  if(write && !WRITABLE){
+    throw std::runtime_error("the mapped vector was opened read-only");
+  }
+
+  // Two chunks are in flight at a time: the kernels of chunk k are
+  // submitted before chunk k - 1 is waited on, so the runtime copies one
+  // chunk while it computes the other, and the kernel reads chunk k + 1
+  // from the disk ahead of both.
+  std::optional<sycl::buffer<double>> previous;
+  size_t previous_begin = 0;
+  size_t previous_end   = 0;
+
+  const auto release_previous = [&](){
+    if(previous){
+      // destroying the buffer waits for its kernels and copies it back
+      previous.reset();
+      advise(previous_begin, previous_end, MADV_DONTNEED);
+    }
+  };
+
+  for(size_t begin = 0; begin < SIZE; begin += CHUNK_SIZE){
+    const size_t N    = std::min(CHUNK_SIZE, SIZE - begin);
+    const size_t next = begin + N;
+    if(next < SIZE){
+      advise(next, std::min(next + CHUNK_SIZE, SIZE), MADV_WILLNEED);
+    }
+
+    sycl::buffer<double> chunk{data() + begin, sycl::range<1>{N}};
+    if(!write){
+      // read-only passes must not dirty the pages of the mapping
+      chunk.set_write_back(false);
+    }
+    f(chunk, begin, N);
+
+    release_previous();
+    previous.emplace(std::move(chunk));
+    previous_begin = begin;
+    previous_end   = next;
+  }
+  release_previous();
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Op_type>
+double Sycl_Mapped_Vector::reduce(double identity, Op_type op){
+  if(SIZE == 0){
+    return identity;
+  }
+
+  // each chunk leaves its tile partials at its own offset, the partials
+  // are reduced once all chunks are done, in the same order every time.
+  // Every chunk writes through its own buffer so the runtime does not
+  // order its kernel after the previous chunk's
+  const size_t TILE            = reduce_tile_size(Q);
+  const size_t TILES_PER_CHUNK = (CHUNK_SIZE + TILE - 1)/TILE;
+  const size_t N_CHUNKS        = (SIZE + CHUNK_SIZE - 1)/CHUNK_SIZE;
+  const size_t LAST_N          = SIZE - (N_CHUNKS - 1)*CHUNK_SIZE;
+  const size_t N_PARTIALS      = (N_CHUNKS - 1)*TILES_PER_CHUNK + (LAST_N + TILE - 1)/TILE;
+
+  std::vector<double> partials(N_PARTIALS);
+  std::deque<sycl::buffer<double>> chunk_partials;
+  for_each_chunk(false, [&](sycl::buffer<double>& chunk, size_t begin, size_t N){
+    const size_t first = begin/CHUNK_SIZE*TILES_PER_CHUNK;
+    chunk_partials.emplace_back(partials.data() + first, sycl::range<1>{(N + TILE - 1)/TILE});
+    reduce_tiles(Q, chunk, N, identity, op, chunk_partials.back(), 0);
+
+    // the chunk before the previous one is done, releasing its partials
+    // does not wait
+    if(chunk_partials.size() > 2){
+      chunk_partials.pop_front();
+    }
+  });
+  chunk_partials.clear();
+
+  sycl::buffer<double> partial_buffer{partials.data(), sycl::range<1>{N_PARTIALS}};
+  return reduce_buffer(Q, partial_buffer, N_PARTIALS, identity, op);
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Mapped_Vector::size(){
+  return SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Mapped_Vector::chunk_size(){
+  return CHUNK_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::add_each_element(double x){
+  apply_batch({VECTOR_OP_ADD}, {x});
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::subtract_each_element(double x){
+  apply_batch({VECTOR_OP_SUBTRACT}, {x});
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::multiply_each_element(double x){
+  apply_batch({VECTOR_OP_MULTIPLY}, {x});
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::divide_each_element(double x){
+  apply_batch({VECTOR_OP_DIVIDE}, {x});
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::apply_batch(const std::vector<int>& op_codes, const std::vector<double>& x){
+  check_vector_ops(op_codes, x);
+
+  if(op_codes.empty() || SIZE == 0){
+    return;
+  }
+
+  const size_t N_OPS = op_codes.size();
+
+  // creating a sycl scope
+  {
+    // creating buffers for the op chain, shared by all chunks
+    sycl::buffer<int> op_buffer{op_codes.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<double> x_buffer{x.data(), sycl::range<1>{N_OPS}};
+
+    for_each_chunk(true, [&](sycl::buffer<double>& chunk, size_t, size_t N){
+      Q.submit([&](sycl::handler &h){
+        // creating device accessors
+        sycl::accessor A_access{chunk, h};
+        sycl::accessor op_access{op_buffer, h, sycl::read_only};
+        sycl::accessor x_access{x_buffer, h, sycl::read_only};
+        parallel_for_each(h, N, [=](size_t idx){
+          double value = A_access[idx];
+          for(size_t k = 0; k < N_OPS; ++k){
+            value = apply_vector_op(op_access[k], value, x_access[k]);
+          }
+          A_access[idx] = value;
+        });
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::apply_batch(const std::string& ops){
+  std::vector<int> op_codes;
+  std::vector<double> x;
+  parse_vector_ops(ops, op_codes, x);
+  apply_batch(op_codes, x);
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Mapped_Vector::sum(){
+  return reduce(0.0, sycl::plus<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Mapped_Vector::min(){
+  return reduce(std::numeric_limits<double>::infinity(), sycl::minimum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Mapped_Vector::max(){
+  return reduce(-std::numeric_limits<double>::infinity(), sycl::maximum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Mapped_Vector::flush(){
+  if(WRITABLE && MAP){
+    const size_t BYTES = DATA_OFFSET + SIZE*sizeof(double);
+    if(msync(MAP.get(), BYTES, MS_SYNC) != 0){
+      throw std::runtime_error(std::string("cannot flush the mapped vector: ") + std::strerror(errno));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<double> Sycl_Mapped_Vector::get_array(){
+  // aliasing the mapping so the array keeps the file mapped
+  py::array_t<double> array = share_storage(std::shared_ptr<double>(MAP, SIZE > 0 ? data() : nullptr), SIZE);
+  if(!WRITABLE){
+    // writing through a read-only mapping would crash rather than raise
+    array.attr("setflags")(py::arg("write") = false);
+  }
+  return array;
+}
+
+#endif //#ifndef MAPPED_VECTOR_CPP
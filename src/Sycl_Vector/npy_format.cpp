@@ -0,0 +1,170 @@
+#ifndef NPY_FORMAT_CPP
+#define NPY_FORMAT_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the parts of the NumPy .npy format used to
+//         map, save and load float64 vectors
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Npy Format
+/// \brief    Reading and writing .npy headers
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Magic string that starts every .npy file
+constexpr char NPY_MAGIC[] = "\x93NUMPY";
+constexpr size_t NPY_MAGIC_BYTES = 6;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Location of the float64 data of a .npy file
+struct Npy_Header{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Bytes before the first element
+  size_t data_offset;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of elements
+  size_t SIZE;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns true when the N_BYTES bytes start with the .npy magic
+inline bool is_npy(const char* bytes, size_t N_BYTES){
+  return N_BYTES >= NPY_MAGIC_BYTES && std::memcmp(bytes, NPY_MAGIC, NPY_MAGIC_BYTES) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the value that follows key in the header dictionary
+inline std::string npy_header_value(const std::string& header, const std::string& key){
+  const size_t key_pos = header.find("'" + key + "'");
+  const size_t colon   = key_pos == std::string::npos ? key_pos : header.find(':', key_pos);
+  if(colon == std::string::npos){
+    throw std::invalid_argument("the .npy header has no '" + key + "'");
+  }
+
+  size_t begin = colon + 1;
+  while(begin < header.size() && header[begin] == ' '){
+    ++begin;
+  }
+  // a tuple ends at its closing parenthesis, anything else at the next comma
+  const size_t end = header[begin] == '(' ? header.find(')', begin) + 1
+                                          : header.find_first_of(",}", begin);
+  return header.substr(begin, end - begin);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Largest length of the magic, version and header length fields
+constexpr size_t NPY_PREFIX_BYTES = 12;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the number of bytes before the data of a .npy file
+///        from its first N_BYTES bytes, at least the first
+///        NPY_PREFIX_BYTES unless the file is shorter
+inline size_t npy_header_bytes(const char* bytes, size_t N_BYTES){
+  if(!is_npy(bytes, N_BYTES) || N_BYTES < NPY_MAGIC_BYTES + 4){
+    throw std::invalid_argument("not a .npy file");
+  }
+
+  // version 1 stores the header length in 2 bytes, later versions in 4
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(bytes);
+  const int major = u[6];
+  size_t header_bytes = u[8] | (size_t(u[9]) << 8);
+  if(major < 2){
+    return 10 + header_bytes;
+  }
+  if(N_BYTES < NPY_PREFIX_BYTES){
+    throw std::invalid_argument("truncated .npy header");
+  }
+  header_bytes |= (size_t(u[10]) << 16) | (size_t(u[11]) << 24);
+  return NPY_PREFIX_BYTES + header_bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Parses the header of a .npy file holding C ordered little
+///        endian float64 values, any shape is read as a flat vector.
+///        FILE_BYTES bytes hold the header and the data, shapes that
+///        overflow or do not fit in them are rejected
+inline Npy_Header parse_npy_header(const char* bytes, size_t N_BYTES, size_t FILE_BYTES){
+  const size_t DATA_OFFSET = npy_header_bytes(bytes, N_BYTES);
+  if(DATA_OFFSET > N_BYTES){
+    throw std::invalid_argument("truncated .npy header");
+  }
+  const size_t prefix = static_cast<unsigned char>(bytes[6]) < 2 ? 10 : NPY_PREFIX_BYTES;
+  const std::string header(bytes + prefix, DATA_OFFSET - prefix);
+
+  const std::string descr = npy_header_value(header, "descr");
+  if(descr != "'<f8'" && descr != "'float64'"){
+    throw std::invalid_argument("only little endian float64 .npy files are supported, got " + descr);
+  }
+
+  size_t SIZE = 1;
+  size_t n_dims = 0;
+  const std::string shape = npy_header_value(header, "shape");
+  for(size_t pos = 0; pos < shape.size(); ++pos){
+    if(shape[pos] >= '0' && shape[pos] <= '9'){
+      size_t extent = 0;
+      while(pos < shape.size() && shape[pos] >= '0' && shape[pos] <= '9'){
+        const size_t digit = static_cast<size_t>(shape[pos++] - '0');
+        if(extent > (std::numeric_limits<size_t>::max() - digit)/10){
+          throw std::invalid_argument("the .npy shape overflows");
+        }
+        extent = extent*10 + digit;
+      }
+      if(extent != 0 && SIZE > std::numeric_limits<size_t>::max()/extent){
+        throw std::invalid_argument("the .npy shape overflows");
+      }
+      SIZE *= extent;
+      ++n_dims;
+    }
+  }
+
+  // the callers add the data offset to the data size, which cannot wrap
+  // once the size is below the file size
+  if(SIZE > FILE_BYTES/sizeof(double)){
+    throw std::invalid_argument("the .npy shape holds more values than the file");
+  }
+
+  if(n_dims > 1 && npy_header_value(header, "fortran_order") != "False"){
+    throw std::invalid_argument("Fortran ordered .npy files are not supported");
+  }
+
+  return Npy_Header{DATA_OFFSET, SIZE};
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns a version 1.0 header for SIZE float64 values, padded so
+///        the data starts at a multiple of ALIGNMENT bytes (numpy itself
+///        aligns to 64, larger alignments allow O_DIRECT transfers)
+inline std::string make_npy_header(size_t SIZE, size_t ALIGNMENT){
+  std::string header = "{'descr': '<f8', 'fortran_order': False, 'shape': ("
+                     + std::to_string(SIZE) + ",), }";
+
+  // padding with spaces up to the newline that ends the header
+  const size_t BYTES = (10 + header.size() + 1 + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT;
+  header.append(BYTES - 10 - header.size() - 1, ' ');
+  header += '\n';
+
+  const size_t HEADER_BYTES = header.size();
+  if(HEADER_BYTES > 0xFFFF){
+    throw std::invalid_argument("the .npy alignment is too large for a version 1.0 header");
+  }
+  std::string result(NPY_MAGIC, NPY_MAGIC_BYTES);
+  result += '\x01';
+  result += '\x00';
+  result += static_cast<char>(HEADER_BYTES & 0xFF);
+  result += static_cast<char>(HEADER_BYTES >> 8);
+  return result + header;
+}
+
+/// @}
+// end "Npy Format" doxygen group
+
+#endif //#ifndef NPY_FORMAT_CPP
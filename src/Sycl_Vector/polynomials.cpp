@@ -0,0 +1,81 @@
+#ifndef POLYNOMIALS_CPP
+#define POLYNOMIALS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the polynomial helpers used by the polynomial
+//         and piecewise polynomial evaluation kernels
+///////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Polynomials
+/// \brief    Horner evaluation and piece lookup
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Evaluates the polynomial with the N_COEFFICIENTS coefficients
+///        starting at coefficients[first], highest degree first, with one
+///        fused multiply-add per coefficient, usable inside sycl kernels
+template<typename Coefficients_type>
+double horner(const Coefficients_type& coefficients, size_t first, size_t N_COEFFICIENTS, double value){
+  double result = 0.0;
+  for(size_t k = 0; k < N_COEFFICIENTS; ++k){
+    result = sycl::fma(result, value, coefficients[first + k]);
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the piece of a value among N_PIECES pieces delimited by
+///        N_PIECES + 1 increasing breaks, values outside the breaks use the
+///        first or last piece
+template<typename Breaks_type>
+size_t find_piece(const Breaks_type& breaks, size_t N_PIECES, double value){
+  size_t first = 0;
+  size_t last  = N_PIECES;
+  while(last - first > 1){
+    const size_t middle = (first + last)/2;
+    if(breaks[middle] <= value){
+      first = middle;
+    }
+    else{
+      last = middle;
+    }
+  }
+  return first;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Checks that the breaks are finite and increasing and that every
+///        piece has the same, non-zero number of coefficients, returns
+///        that number
+inline size_t check_piecewise_polynomial(const std::vector<double>& breaks,
+                                         const std::vector<std::vector<double>>& coefficients){
+  if(breaks.size() < 2 || coefficients.size() != breaks.size() - 1){
+    throw std::invalid_argument("a piecewise polynomial needs one more break than pieces");
+  }
+  for(size_t i = 0; i < breaks.size(); ++i){
+    if(!std::isfinite(breaks[i]) || (i > 0 && !(breaks[i - 1] < breaks[i]))){
+      throw std::invalid_argument("breaks must be finite and increasing");
+    }
+  }
+  const size_t N_COEFFICIENTS = coefficients[0].size();
+  for(const auto& piece : coefficients){
+    if(piece.size() != N_COEFFICIENTS || N_COEFFICIENTS == 0){
+      throw std::invalid_argument("each piece needs the same, non-zero number of coefficients");
+    }
+  }
+  return N_COEFFICIENTS;
+}
+
+/// @}
+// end "Polynomials" doxygen group
+
+#endif //#ifndef POLYNOMIALS_CPP
@@ -0,0 +1,128 @@
+#ifndef QUERY_KERNELS_CPP
+#define QUERY_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the predicate queries (counting and searching)
+//         evaluated on the device without copying the vector back
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Work-group sizes
+#include "scan_kernels.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Query Kernels
+/// \brief    Counting and early exit searches over predicates
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of work-group sized chunks visited by each work-group
+constexpr size_t QUERY_CHUNKS_PER_TILE = 16;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the number of the first N elements of data for which
+///        predicate(value) is true
+template<typename Predicate_type>
+size_t count_if_buffer(sycl::queue& Q, sycl::buffer<double>& data, size_t N,
+                       Predicate_type predicate){
+  if(N == 0){
+    return 0;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*QUERY_CHUNKS_PER_TILE;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  uint64_t count = 0;
+  // creating a sycl scope
+  {
+    sycl::buffer<uint64_t> count_buffer{&count, sycl::range<1>{1}};
+
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor data_access{data, h, sycl::read_only};
+      sycl::accessor count_access{count_buffer, h};
+      h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+        const size_t begin = item.get_group(0)*TILE;
+        const size_t end   = sycl::min(begin + TILE, N);
+
+        uint64_t local_count = 0;
+        for(size_t i = begin + item.get_local_id(0); i < end; i += L){
+          local_count += predicate(data_access[i]) ? 1 : 0;
+        }
+
+        // one device atomic per work-group
+        local_count = sycl::reduce_over_group(item.get_group(), local_count, sycl::plus<uint64_t>());
+        if(item.get_local_id(0) == 0 && local_count != 0){
+          sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                           sycl::access::address_space::global_space> counter{count_access[0]};
+          counter.fetch_add(local_count);
+        }
+      });
+    });
+  }
+
+  return static_cast<size_t>(count);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the index of the first of the first N elements of data
+///        for which predicate(value) is true, or N when there is none
+///
+/// The lowest hit so far is kept in a device atomic. Every work-item
+/// reads it before each chunk and stops as soon as a hit at a lower index
+/// is known, so work-groups scheduled after the first hit return almost
+/// immediately and a hit near the front costs a small part of a full pass.
+template<typename Predicate_type>
+size_t find_first_buffer(sycl::queue& Q, sycl::buffer<double>& data, size_t N,
+                         Predicate_type predicate){
+  if(N == 0){
+    return 0;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*QUERY_CHUNKS_PER_TILE;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  uint64_t first = N;
+  // creating a sycl scope
+  {
+    sycl::buffer<uint64_t> first_buffer{&first, sycl::range<1>{1}};
+
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor data_access{data, h, sycl::read_only};
+      sycl::accessor first_access{first_buffer, h};
+      h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+        sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                         sycl::access::address_space::global_space> first_hit{first_access[0]};
+
+        const size_t begin = item.get_group(0)*TILE;
+        const size_t end   = sycl::min(begin + TILE, N);
+
+        for(size_t chunk = begin; chunk < end; chunk += L){
+          if(first_hit.load() < chunk){
+            return;
+          }
+          const size_t i = chunk + item.get_local_id(0);
+          if(i < end && predicate(data_access[i])){
+            first_hit.fetch_min(static_cast<uint64_t>(i));
+            return;
+          }
+        }
+      });
+    });
+  }
+
+  return static_cast<size_t>(first);
+}
+
+/// @}
+// end "Query Kernels" doxygen group
+
+#endif //#ifndef QUERY_KERNELS_CPP
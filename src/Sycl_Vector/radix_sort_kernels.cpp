@@ -0,0 +1,170 @@
+#ifndef RADIX_SORT_KERNELS_CPP
+#define RADIX_SORT_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a least significant digit radix sort over the
+//         bit patterns of doubles, with an optional index payload
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Prefix scans
+#include "scan_kernels.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Radix Sort Kernels
+/// \brief    Stable radix sort with work-group local histograms
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of key bits sorted in each pass
+constexpr unsigned RADIX_BITS = 4;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of distinct digits in each pass
+constexpr unsigned RADIX_DIGITS = 1u << RADIX_BITS;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of consecutive keys owned by each work-item
+constexpr size_t RADIX_ITEMS_PER_WORK_ITEM = 16;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Maps a double to an unsigned key with the same ordering,
+///        negatives are flipped and every NaN sorts after +inf
+inline uint64_t radix_key_from_double(double value){
+  if(sycl::isnan(value)){
+    return ~uint64_t(0);
+  }
+  const uint64_t bits = sycl::bit_cast<uint64_t>(value);
+  return (bits >> 63) ? ~bits : (bits | (uint64_t(1) << 63));
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Maps a key produced by radix_key_from_double back to a double
+inline double double_from_radix_key(uint64_t key){
+  const uint64_t bits = (key >> 63) ? (key & ~(uint64_t(1) << 63)) : ~key;
+  return sycl::bit_cast<double>(bits);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Sorts the first N keys in ascending order, and moves the
+///        indices along with them when With_indices is set
+///
+/// Each pass counts the digits of every tile in a work-group local
+/// histogram, scans the (digit, tile) counts with scan_buffer and then
+/// scatters the keys. Every work-item owns consecutive keys and offsets
+/// its writes by an exclusive scan over the work-group, so each pass is
+/// stable and the passes can go from the least to the most significant
+/// digit.
+template<bool With_indices>
+void radix_sort_buffer(sycl::queue& Q, sycl::buffer<uint64_t>& keys,
+                       sycl::buffer<int64_t>& indices, size_t N){
+  if(N < 2){
+    return;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*RADIX_ITEMS_PER_WORK_ITEM;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  sycl::buffer<uint64_t> keys_swap{sycl::range<1>{N}};
+  sycl::buffer<int64_t> indices_swap{sycl::range<1>{With_indices ? N : 1}};
+  sycl::buffer<size_t> count_buffer{sycl::range<1>{RADIX_DIGITS*N_TILES}};
+
+  sycl::buffer<uint64_t>* keys_in    = &keys;
+  sycl::buffer<uint64_t>* keys_out   = &keys_swap;
+  sycl::buffer<int64_t>*  indices_in  = &indices;
+  sycl::buffer<int64_t>*  indices_out = &indices_swap;
+
+  for(unsigned shift = 0; shift < 64; shift += RADIX_BITS){
+    // counting the digits of each tile
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor key_access{*keys_in, h, sycl::read_only};
+      sycl::accessor count_access{count_buffer, h, sycl::write_only, sycl::no_init};
+      sycl::local_accessor<uint32_t> histogram{sycl::range<1>{RADIX_DIGITS}, h};
+      h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+        const auto group    = item.get_group();
+        const size_t tile   = item.get_group(0);
+        const size_t local  = item.get_local_id(0);
+        const size_t begin  = sycl::min(tile*TILE + local*RADIX_ITEMS_PER_WORK_ITEM, N);
+        const size_t end    = sycl::min(begin + RADIX_ITEMS_PER_WORK_ITEM, N);
+
+        for(size_t d = local; d < RADIX_DIGITS; d += L){
+          histogram[d] = 0;
+        }
+        sycl::group_barrier(group);
+
+        for(size_t i = begin; i < end; ++i){
+          const uint32_t digit = (key_access[i] >> shift) & (RADIX_DIGITS - 1);
+          sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed, sycl::memory_scope::work_group,
+                           sycl::access::address_space::local_space> counter{histogram[digit]};
+          counter.fetch_add(1u);
+        }
+        sycl::group_barrier(group);
+
+        for(size_t d = local; d < RADIX_DIGITS; d += L){
+          count_access[d*N_TILES + tile] = histogram[d];
+        }
+      });
+    });
+
+    // turning the digit-major counts into the first output slot of each
+    // (digit, tile) pair
+    scan_buffer(Q, count_buffer, RADIX_DIGITS*N_TILES, size_t(0), sycl::plus<size_t>(), false);
+
+    // scattering the keys to their slots
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor key_access{*keys_in, h, sycl::read_only};
+      sycl::accessor key_out_access{*keys_out, h, sycl::write_only, sycl::no_init};
+      sycl::accessor index_access{*indices_in, h, sycl::read_only};
+      sycl::accessor index_out_access{*indices_out, h, sycl::write_only, sycl::no_init};
+      sycl::accessor count_access{count_buffer, h, sycl::read_only};
+      h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+        const auto group    = item.get_group();
+        const size_t tile   = item.get_group(0);
+        const size_t local  = item.get_local_id(0);
+        const size_t begin  = sycl::min(tile*TILE + local*RADIX_ITEMS_PER_WORK_ITEM, N);
+        const size_t end    = sycl::min(begin + RADIX_ITEMS_PER_WORK_ITEM, N);
+
+        size_t counts[RADIX_DIGITS] = {};
+        for(size_t i = begin; i < end; ++i){
+          ++counts[(key_access[i] >> shift) & (RADIX_DIGITS - 1)];
+        }
+
+        size_t slots[RADIX_DIGITS];
+        for(unsigned d = 0; d < RADIX_DIGITS; ++d){
+          slots[d] = count_access[d*N_TILES + tile]
+                   + sycl::exclusive_scan_over_group(group, counts[d], size_t(0), sycl::plus<size_t>());
+        }
+
+        for(size_t i = begin; i < end; ++i){
+          const uint64_t key = key_access[i];
+          const size_t slot = slots[(key >> shift) & (RADIX_DIGITS - 1)]++;
+          key_out_access[slot] = key;
+          if constexpr(With_indices){
+            index_out_access[slot] = index_access[i];
+          }
+        }
+      });
+    });
+
+    std::swap(keys_in, keys_out);
+    std::swap(indices_in, indices_out);
+  }
+
+  // 64/RADIX_BITS is even, so the sorted keys end up back in keys
+  static_assert((64/RADIX_BITS) % 2 == 0, "radix sort must finish in the input buffer");
+}
+
+/// @}
+// end "Radix Sort Kernels" doxygen group
+
+#endif //#ifndef RADIX_SORT_KERNELS_CPP
@@ -0,0 +1,249 @@
+#ifndef RAGGED_VECTOR_CPP
+#define RAGGED_VECTOR_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a ragged vector of vectors in CSR layout, with
+//         segmented operations that are executed in single kernels
+///////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Shared storage, segmented kernels and scan ops
+#include "vector_storage.cpp"
+#include "segmented_kernels.cpp"
+#include "scan_kernels.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Ragged Vector
+/// \brief    Creates a CSR style ragged vector of sycl based vectors
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Holds variable length segments in one Basic_Sycl_Vector with an
+///        offsets table
+
+class Sycl_Ragged_Vector{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Values of all segments
+  Basic_Sycl_Vector VALUES;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of segments
+  size_t N_SEGMENTS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Start of each segment in the values, the last entry is the
+  ///        total number of values
+  std::shared_ptr<int64_t> OFFSETS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Checks that the offsets describe the values
+  void check_offsets();
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Reduces each segment with the operation op in a single kernel
+  template<typename Op_type>
+  std::vector<double> reduce_each_segment(double identity, Op_type op);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Applies the operation op with the scalar x[s] to segment s
+  void apply_each_segment(int op, const std::vector<double>& x);
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of segments
+    size_t size();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of each segment
+    std::vector<double> sum_each_segment();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of each segment
+    std::vector<double> min_each_segment();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of each segment
+    std::vector<double> max_each_segment();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each segment by its inclusive scan with the
+    ///        operation op ("sum", "prod", "min" or "max")
+    void inclusive_scan_each_segment(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces each segment by its exclusive scan with the
+    ///        operation op ("sum", "prod", "min" or "max")
+    void exclusive_scan_each_segment(const std::string& op);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds the value x[s] to each element of segment s
+    void add_each_segment(const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Subtracts the value x[s] from each element of segment s
+    void subtract_each_segment(const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Multiplies each element of segment s by the value x[s]
+    void multiply_each_segment(const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Divides each element of segment s by the value x[s]
+    void divide_each_segment(const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a NumPy array that shares the values
+    py::array_t<double> get_values();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a read-only NumPy array that shares the offsets
+    py::array_t<int64_t> get_offsets();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that initializes zero segments of the given sizes
+    Sycl_Ragged_Vector(const std::vector<size_t>& sizes):
+      VALUES(0), N_SEGMENTS(sizes.size()), OFFSETS(allocate_storage<int64_t>(sizes.size() + 1)){
+      int64_t* offsets = OFFSETS.get();
+      for(size_t s = 0; s < N_SEGMENTS; ++s){
+        offsets[s + 1] = offsets[s] + static_cast<int64_t>(sizes[s]);
+      }
+      VALUES = Basic_Sycl_Vector(static_cast<size_t>(offsets[N_SEGMENTS]));
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that adopts the memory of NumPy values and
+    ///        offsets arrays without copying
+    Sycl_Ragged_Vector(py::array_t<double, py::array::c_style> values,
+                       py::array_t<int64_t, py::array::c_style> offsets):
+      VALUES(values), N_SEGMENTS(offsets.size() == 0 ? 0 : offsets.size() - 1),
+      OFFSETS(adopt_storage(offsets)){
+      if(offsets.size() == 0){
+        throw std::invalid_argument("offsets need at least one entry");
+      }
+      check_offsets();
+    }
+};
+
+/// @}
+// end "Sycl Ragged Vector" doxygen group
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::check_offsets(){
+  const int64_t* offsets = OFFSETS.get();
+
+  if(offsets[0] != 0){
+    throw std::invalid_argument("offsets must start at zero");
+  }
+
+  for(size_t s = 0; s < N_SEGMENTS; ++s){
+    if(offsets[s + 1] < offsets[s]){
+      throw std::invalid_argument("offsets must be non-decreasing");
+    }
+  }
+
+  if(static_cast<size_t>(offsets[N_SEGMENTS]) != VALUES.SIZE){
+    throw std::invalid_argument("last offset must equal the number of values");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Op_type>
+std::vector<double> Sycl_Ragged_Vector::reduce_each_segment(double identity, Op_type op){
+  std::vector<double> result(N_SEGMENTS);
+  reduce_segments(VALUES.Q, VALUES.A.get(), VALUES.SIZE, OFFSETS.get(), N_SEGMENTS,
+                  identity, op, result.data());
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::apply_each_segment(int op, const std::vector<double>& x){
+  if(x.size() != N_SEGMENTS){
+    throw std::invalid_argument("expected one scalar per segment");
+  }
+  apply_op_segments(VALUES.Q, VALUES.A.get(), VALUES.SIZE, OFFSETS.get(), N_SEGMENTS,
+                    op, x.data());
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Ragged_Vector::size(){
+  return N_SEGMENTS;
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Ragged_Vector::sum_each_segment(){
+  return reduce_each_segment(0.0, sycl::plus<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Ragged_Vector::min_each_segment(){
+  return reduce_each_segment(std::numeric_limits<double>::infinity(), sycl::minimum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Ragged_Vector::max_each_segment(){
+  return reduce_each_segment(-std::numeric_limits<double>::infinity(), sycl::maximum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::inclusive_scan_each_segment(const std::string& op){
+  with_scan_op(op, [&](double identity, auto scan_op){
+    scan_segments(VALUES.Q, VALUES.A.get(), VALUES.SIZE, OFFSETS.get(), N_SEGMENTS,
+                  identity, scan_op, true);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::exclusive_scan_each_segment(const std::string& op){
+  with_scan_op(op, [&](double identity, auto scan_op){
+    scan_segments(VALUES.Q, VALUES.A.get(), VALUES.SIZE, OFFSETS.get(), N_SEGMENTS,
+                  identity, scan_op, false);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::add_each_segment(const std::vector<double>& x){
+  apply_each_segment(VECTOR_OP_ADD, x);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::subtract_each_segment(const std::vector<double>& x){
+  apply_each_segment(VECTOR_OP_SUBTRACT, x);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::multiply_each_segment(const std::vector<double>& x){
+  apply_each_segment(VECTOR_OP_MULTIPLY, x);
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ragged_Vector::divide_each_segment(const std::vector<double>& x){
+  apply_each_segment(VECTOR_OP_DIVIDE, x);
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<double> Sycl_Ragged_Vector::get_values(){
+  return VALUES.get_array();
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Sycl_Ragged_Vector::get_offsets(){
+  py::array_t<int64_t> array = share_storage(OFFSETS, N_SEGMENTS + 1);
+  // the segmented kernels trust the offsets checked by check_offsets
+  array.attr("setflags")(py::arg("write") = false);
+  return array;
+}
+
+#endif //#ifndef RAGGED_VECTOR_CPP
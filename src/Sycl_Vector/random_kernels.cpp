@@ -0,0 +1,86 @@
+#ifndef RANDOM_KERNELS_CPP
+#define RANDOM_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a counter based Philox4x32-10 generator, so
+//         that every element draws its own reproducible random numbers
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Random Kernels
+/// \brief    Counter based random numbers for parallel kernels
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Four 32 bit words, used as the counter and the output of the
+///        generator
+struct Philox_Block{
+  uint32_t word[4];
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the Philox4x32-10 block for a counter and a 64 bit key
+///
+/// The output only depends on the counter and the key, so a kernel that
+/// uses the element index as the counter draws the same numbers no
+/// matter how the work is split into work-groups.
+inline Philox_Block philox4x32_10(Philox_Block counter, uint64_t key){
+  constexpr uint32_t M0 = 0xD2511F53u;
+  constexpr uint32_t M1 = 0xCD9E8D57u;
+  constexpr uint32_t W0 = 0x9E3779B9u;
+  constexpr uint32_t W1 = 0xBB67AE85u;
+
+  uint32_t k0 = static_cast<uint32_t>(key);
+  uint32_t k1 = static_cast<uint32_t>(key >> 32);
+  uint32_t* c = counter.word;
+
+  for(int round = 0; round < 10; ++round){
+    const uint64_t p0 = static_cast<uint64_t>(M0)*c[0];
+    const uint64_t p1 = static_cast<uint64_t>(M1)*c[2];
+    const uint32_t c0 = static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+    const uint32_t c2 = static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+    c[1] = static_cast<uint32_t>(p1);
+    c[3] = static_cast<uint32_t>(p0);
+    c[0] = c0;
+    c[2] = c2;
+    k0 += W0;
+    k1 += W1;
+  }
+  return counter;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns a double in [0, 1) made of 53 random bits
+inline double uniform_from_bits(uint32_t high, uint32_t low){
+  const uint64_t bits = (static_cast<uint64_t>(high) << 32) | low;
+  return static_cast<double>(bits >> 11)*0x1.0p-53;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Draws two uniform doubles in [0, 1) for element i of the stream
+///        selected by seed
+inline void philox_uniform2(uint64_t seed, size_t i, double& u0, double& u1){
+  const Philox_Block block = philox4x32_10(
+    Philox_Block{{static_cast<uint32_t>(i), static_cast<uint32_t>(static_cast<uint64_t>(i) >> 32), 0u, 0u}}, seed);
+  u0 = uniform_from_bits(block.word[0], block.word[1]);
+  u1 = uniform_from_bits(block.word[2], block.word[3]);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns a standard normal sample from two uniforms in [0, 1)
+///        with the Box-Muller transform
+inline double normal_from_uniform2(double u0, double u1){
+  constexpr double TWO_PI = 6.283185307179586476925286766559;
+  return sycl::sqrt(-2.0*sycl::log(1.0 - u0))*sycl::cos(TWO_PI*u1);
+}
+
+/// @}
+// end "Random Kernels" doxygen group
+
+#endif //#ifndef RANDOM_KERNELS_CPP
@@ -0,0 +1,98 @@
+#ifndef REDUCE_KERNELS_CPP
+#define REDUCE_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a deterministic tiled reduction over sycl
+//         buffers, used by the vector classes
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Work-group sizes
+#include "scan_kernels.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Reduce Kernels
+/// \brief    Tiled reductions with one partial per work-group
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of work-group sized chunks reduced by each work-group
+constexpr size_t REDUCE_CHUNKS_PER_TILE = 16;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of elements reduced into one partial
+inline size_t reduce_tile_size(sycl::queue& Q){
+  return scan_work_group_size(Q)*REDUCE_CHUNKS_PER_TILE;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reduces each tile of reduce_tile_size(Q) elements of the first N
+///        elements of data with op, writing the result of tile t to
+///        partials[first_partial + t]
+///
+/// The partials are combined in a fixed order, so the result does not
+/// depend on scheduling, unlike atomics on floating point values.
+template<typename Value_type, typename Op_type>
+void reduce_tiles(sycl::queue& Q, sycl::buffer<Value_type>& data, size_t N,
+                  Value_type identity, Op_type op,
+                  sycl::buffer<Value_type>& partials, size_t first_partial){
+  if(N == 0){
+    return;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*REDUCE_CHUNKS_PER_TILE;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor data_access{data, h, sycl::read_only};
+    sycl::accessor partial_access{partials, h, sycl::write_only};
+    h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+      const size_t begin = item.get_group(0)*TILE;
+      const size_t end   = sycl::min(begin + TILE, N);
+
+      Value_type value = identity;
+      for(size_t i = begin + item.get_local_id(0); i < end; i += L){
+        value = op(value, data_access[i]);
+      }
+
+      value = sycl::reduce_over_group(item.get_group(), value, identity, op);
+      if(item.get_local_id(0) == 0){
+        partial_access[first_partial + item.get_group(0)] = value;
+      }
+    });
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the reduction of the first N elements of data with op,
+///        reducing the tile partials again until one value is left
+template<typename Value_type, typename Op_type>
+Value_type reduce_buffer(sycl::queue& Q, sycl::buffer<Value_type>& data, size_t N,
+                         Value_type identity, Op_type op){
+  if(N == 0){
+    return identity;
+  }
+
+  const size_t TILE    = reduce_tile_size(Q);
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  sycl::buffer<Value_type> partials{sycl::range<1>{N_TILES}};
+  reduce_tiles(Q, data, N, identity, op, partials, 0);
+
+  if(N_TILES == 1){
+    return sycl::host_accessor{partials, sycl::read_only}[0];
+  }
+  return reduce_buffer(Q, partials, N_TILES, identity, op);
+}
+
+/// @}
+// end "Reduce Kernels" doxygen group
+
+#endif //#ifndef REDUCE_KERNELS_CPP
@@ -0,0 +1,313 @@
+#ifndef RING_VECTOR_CPP
+#define RING_VECTOR_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a fixed capacity ring buffer vector that keeps
+//         the statistics of its window up to date on every append
+///////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Shared storage, launches and reductions
+#include "vector_storage.cpp"
+#include "kernel_ranges.cpp"
+#include "reduce_kernels.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Ring Vector
+/// \brief    Creates a sliding window sycl based vector
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Keeps the last CAPACITY appended values and their sum, mean,
+///        variance, minimum and maximum
+///
+/// Appending N values costs O(N) whatever the capacity. The sum and the
+/// sum of squares are kept relative to a shift near the mean, adding the
+/// new and subtracting the evicted values, and are recomputed from the
+/// window after every CAPACITY evictions so rounding errors cannot build
+/// up. The minimum and maximum come from monotonic queues of (sequence
+/// number, value) pairs, in which every value is pushed and popped once.
+
+class Sycl_Ring_Vector{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Selected device
+  sycl::queue Q;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Maximum number of elements
+  size_t CAPACITY;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of elements in the window
+  size_t SIZE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Sequence number of the next value, which goes to slot
+  ///        NEXT % CAPACITY
+  uint64_t NEXT;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Slots of the ring
+  std::shared_ptr<double> A;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Shift of the running sums, near the mean of the window
+  double SHIFT;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Running sum of value - SHIFT over the window
+  double S1;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Running sum of (value - SHIFT)^2 over the window
+  double S2;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Evictions since the running sums were last recomputed
+  size_t EVICTIONS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Increasing values of the window with their sequence numbers,
+  ///        the minimum in front
+  std::deque<std::pair<uint64_t, double>> MIN_QUEUE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Decreasing values of the window with their sequence numbers,
+  ///        the maximum in front
+  std::deque<std::pair<uint64_t, double>> MAX_QUEUE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Appends one value, evicting the oldest when full
+  void push(double value);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Recomputes the shift and the running sums from the window
+  void resync();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of elements in the window
+    size_t size();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum number of elements
+    size_t capacity();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Appends values, keeping the newest CAPACITY values
+    void append(py::array_t<double, py::array::c_style> values);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Empties the window
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of the window
+    double sum();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the mean of the window
+    double mean();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the population variance of the window
+    double variance();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of the window
+    double min();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of the window
+    double max();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a copy of the window, oldest value first
+    py::array_t<double> get_array();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that creates an empty window of capacity values
+    Sycl_Ring_Vector(size_t capacity):
+      CAPACITY(capacity), SIZE(0), NEXT(0), A(allocate_storage<double>(capacity)),
+      SHIFT(0.0), S1(0.0), S2(0.0), EVICTIONS(0){
+      if(CAPACITY == 0){
+        throw std::invalid_argument("capacity must be positive");
+      }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ring_Vector::push(double value){
+  double* slot = A.get() + NEXT % CAPACITY;
+  if(SIZE == CAPACITY){
+    const double evicted = *slot - SHIFT;
+    S1 -= evicted;
+    S2 -= evicted*evicted;
+    ++EVICTIONS;
+  }
+  else{
+    // shifting by the first value keeps the sums small for data with a
+    // large offset until the first resync
+    if(SIZE == 0){
+      SHIFT = value;
+      S1 = S2 = 0.0;
+    }
+    ++SIZE;
+  }
+  *slot = value;
+  const double d = value - SHIFT;
+  S1 += d;
+  S2 += d*d;
+
+  // values that can no longer be the minimum or maximum leave the back
+  while(!MIN_QUEUE.empty() && MIN_QUEUE.back().second >= value){
+    MIN_QUEUE.pop_back();
+  }
+  MIN_QUEUE.emplace_back(NEXT, value);
+  while(!MAX_QUEUE.empty() && MAX_QUEUE.back().second <= value){
+    MAX_QUEUE.pop_back();
+  }
+  MAX_QUEUE.emplace_back(NEXT, value);
+
+  // values that left the window leave the front
+  ++NEXT;
+  while(MIN_QUEUE.front().first + CAPACITY < NEXT){
+    MIN_QUEUE.pop_front();
+  }
+  while(MAX_QUEUE.front().first + CAPACITY < NEXT){
+    MAX_QUEUE.pop_front();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ring_Vector::resync(){
+  EVICTIONS = 0;
+  if(SIZE == 0){
+    SHIFT = S1 = S2 = 0.0;
+    return;
+  }
+
+  // the window fills the first SIZE slots, in rotated order once full,
+  // which the sums do not depend on
+  sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+  A_buffer.set_write_back(false);
+  SHIFT = reduce_buffer(Q, A_buffer, SIZE, 0.0, sycl::plus<double>())/SIZE;
+
+  sycl::buffer<double> d1_buffer{sycl::range<1>{SIZE}};
+  sycl::buffer<double> d2_buffer{sycl::range<1>{SIZE}};
+  const double K = SHIFT;
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor A_access{A_buffer, h, sycl::read_only};
+    sycl::accessor d1_access{d1_buffer, h, sycl::write_only, sycl::no_init};
+    sycl::accessor d2_access{d2_buffer, h, sycl::write_only, sycl::no_init};
+    parallel_for_each(h, SIZE, [=](size_t idx){
+      const double d = A_access[idx] - K;
+      d1_access[idx] = d;
+      d2_access[idx] = d*d;
+    });
+  });
+  S1 = reduce_buffer(Q, d1_buffer, SIZE, 0.0, sycl::plus<double>());
+  S2 = reduce_buffer(Q, d2_buffer, SIZE, 0.0, sycl::plus<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Ring_Vector::size(){
+  return SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Ring_Vector::capacity(){
+  return CAPACITY;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ring_Vector::append(py::array_t<double, py::array::c_style> values){
+  const size_t N = values.size();
+  const double* data = values.data();
+
+  // a batch of at least CAPACITY values replaces the whole window
+  if(N >= CAPACITY){
+    clear();
+    data += N - CAPACITY;
+  }
+
+  const size_t N_KEPT = std::min(N, CAPACITY);
+  for(size_t i = 0; i < N_KEPT; ++i){
+    push(data[i]);
+  }
+
+  if(EVICTIONS >= CAPACITY || N >= CAPACITY){
+    resync();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Ring_Vector::clear(){
+  SIZE = 0;
+  NEXT = 0;
+  SHIFT = S1 = S2 = 0.0;
+  EVICTIONS = 0;
+  MIN_QUEUE.clear();
+  MAX_QUEUE.clear();
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Ring_Vector::sum(){
+  return SIZE*SHIFT + S1;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Ring_Vector::mean(){
+  if(SIZE == 0){
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return SHIFT + S1/SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Ring_Vector::variance(){
+  if(SIZE == 0){
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  const double m = S1/SIZE;
+  return std::max(0.0, S2/SIZE - m*m);
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Ring_Vector::min(){
+  return MIN_QUEUE.empty() ? std::numeric_limits<double>::infinity() : MIN_QUEUE.front().second;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Ring_Vector::max(){
+  return MAX_QUEUE.empty() ? -std::numeric_limits<double>::infinity() : MAX_QUEUE.front().second;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<double> Sycl_Ring_Vector::get_array(){
+  std::shared_ptr<double> window = allocate_storage<double>(SIZE);
+  const size_t OLDEST = SIZE < CAPACITY ? 0 : NEXT % CAPACITY;
+  std::copy(A.get() + OLDEST, A.get() + SIZE, window.get());
+  std::copy(A.get(), A.get() + OLDEST, window.get() + (SIZE - OLDEST));
+  return share_storage(window, SIZE);
+}
+
+/// @}
+// end "Sycl Ring Vector" doxygen group
+
+#endif //#ifndef RING_VECTOR_CPP
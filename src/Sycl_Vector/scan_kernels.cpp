@@ -0,0 +1,132 @@
+#ifndef SCAN_KERNELS_CPP
+#define SCAN_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a multi-level parallel prefix scan over sycl
+//         buffers, used by the vector classes and the scan based algorithms
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Element-wise launches
+#include "kernel_ranges.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Scan Kernels
+/// \brief    Work-efficient multi-level prefix scans
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of work-group sized chunks scanned by each work-group
+constexpr size_t SCAN_CHUNKS_PER_TILE = 8;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Work-group size used by the scan kernels
+inline size_t scan_work_group_size(sycl::queue& Q){
+  return std::min<size_t>(
+    256, Q.get_device().get_info<sycl::info::device::max_work_group_size>());
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Replaces the first N elements of data by their inclusive or
+///        exclusive scan with op, one of the sycl function objects that
+///        exclusive_scan_over_group accepts, such as sycl::plus
+///
+/// Each work-group scans a tile of SCAN_CHUNKS_PER_TILE chunks and records
+/// the tile total, the tile totals are scanned recursively and the tile
+/// prefixes are then added back, so the work stays linear and the number
+/// of levels grows with log(N)/log(tile size).
+template<typename Value_type, typename Op_type>
+void scan_buffer(sycl::queue& Q, sycl::buffer<Value_type>& data, size_t N,
+                 Value_type identity, Op_type op, bool inclusive){
+  if(N == 0){
+    return;
+  }
+
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*SCAN_CHUNKS_PER_TILE;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+
+  sycl::buffer<Value_type> tile_totals{sycl::range<1>{N_TILES}};
+
+  // scanning each tile and recording its total
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor data_access{data, h};
+    sycl::accessor total_access{tile_totals, h, sycl::write_only, sycl::no_init};
+    h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+      const auto group   = item.get_group();
+      const size_t begin = item.get_group(0)*TILE;
+      const size_t end   = sycl::min(begin + TILE, N);
+
+      Value_type carry = identity;
+      for(size_t chunk = begin; chunk < end; chunk += L){
+        const size_t i = chunk + item.get_local_id(0);
+        const Value_type value = i < end ? data_access[i] : identity;
+
+        const Value_type exclusive_value = sycl::exclusive_scan_over_group(group, value, identity, op);
+        const Value_type inclusive_value = op(exclusive_value, value);
+
+        if(i < end){
+          data_access[i] = op(carry, inclusive ? inclusive_value : exclusive_value);
+        }
+        carry = op(carry, sycl::group_broadcast(group, inclusive_value, L - 1));
+      }
+
+      if(item.get_local_id(0) == 0){
+        total_access[item.get_group(0)] = carry;
+      }
+    });
+  });
+
+  if(N_TILES == 1){
+    return;
+  }
+
+  // turning the tile totals into tile prefixes
+  scan_buffer(Q, tile_totals, N_TILES, identity, op, false);
+
+  // adding the tile prefixes back
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor data_access{data, h};
+    sycl::accessor prefix_access{tile_totals, h, sycl::read_only};
+    parallel_for_each(h, N, [=](size_t idx){
+      data_access[idx] = op(prefix_access[idx/TILE], data_access[idx]);
+    });
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Calls f(identity, op) with the operation named by op_name,
+///        one of "sum", "prod", "min" or "max"
+template<typename Function_type>
+void with_scan_op(const std::string& op_name, Function_type f){
+  if(op_name == "sum"){
+    f(0.0, sycl::plus<double>());
+  }
+  else if(op_name == "prod"){
+    f(1.0, sycl::multiplies<double>());
+  }
+  else if(op_name == "min"){
+    f(std::numeric_limits<double>::infinity(), sycl::minimum<double>());
+  }
+  else if(op_name == "max"){
+    f(-std::numeric_limits<double>::infinity(), sycl::maximum<double>());
+  }
+  else{
+    throw std::invalid_argument("unknown scan op '" + op_name + "'");
+  }
+}
+
+/// @}
+// end "Scan Kernels" doxygen group
+
+#endif //#ifndef SCAN_KERNELS_CPP
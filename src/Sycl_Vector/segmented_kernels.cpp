@@ -0,0 +1,196 @@
+#ifndef SEGMENTED_KERNELS_CPP
+#define SEGMENTED_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the kernels shared by the containers that store
+//         many segments in one array described by an offsets table
+///////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <algorithm>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Operation codes, launch limits
+#include "vector_ops.cpp"
+#include "kernel_ranges.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Segmented Kernels
+/// \brief    Single launch kernels over segments described by offsets
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Work-group size for kernels that assign one work-group to each
+///        segment, matched to the mean segment length so that short
+///        segments do not leave most work-items idle
+inline size_t segment_work_group_size(sycl::queue& Q, size_t SIZE, size_t N_SEGMENTS){
+  const size_t max_size = std::min<size_t>(
+    256, Q.get_device().get_info<sycl::info::device::max_work_group_size>());
+  const size_t mean_length = N_SEGMENTS == 0 ? 0 : SIZE/N_SEGMENTS;
+
+  size_t L = 1;
+  while(L < mean_length && 2*L <= max_size){
+    L *= 2;
+  }
+  return L;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of work-groups launched over N_SEGMENTS segments, each
+///        group strides over the segments by this count so that the
+///        launched range stays within MAX_KERNEL_RANGE
+inline size_t segment_group_count(size_t N_SEGMENTS, size_t L){
+  return std::max<size_t>(1, std::min(N_SEGMENTS, MAX_KERNEL_RANGE/L));
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reduces each segment of A with the operation op, writing one
+///        value per segment to result
+template<typename Offset_type, typename Op_type>
+void reduce_segments(sycl::queue& Q, const double* A, size_t SIZE,
+                     const Offset_type* offsets, size_t N_SEGMENTS,
+                     double identity, Op_type op, double* result){
+  std::fill(result, result + N_SEGMENTS, identity);
+  if(SIZE == 0 || N_SEGMENTS == 0){
+    return;
+  }
+
+  const size_t L        = segment_work_group_size(Q, SIZE, N_SEGMENTS);
+  const size_t N_GROUPS = segment_group_count(N_SEGMENTS, L);
+
+  // creating a sycl scope
+  {
+    // creating buffers for the values, the offsets and the results
+    sycl::buffer<double> A_buffer{A, sycl::range<1>{SIZE}};
+    sycl::buffer<Offset_type> offset_buffer{offsets, sycl::range<1>{N_SEGMENTS + 1}};
+    sycl::buffer<double> result_buffer{result, sycl::range<1>{N_SEGMENTS}};
+
+    // executing one work-group per segment at a time in a single sycl
+    // kernel
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h, sycl::read_only};
+      sycl::accessor offset_access{offset_buffer, h, sycl::read_only};
+      sycl::accessor result_access{result_buffer, h, sycl::write_only};
+      h.parallel_for(sycl::nd_range<1>{N_GROUPS*L, L}, [=](sycl::nd_item<1> item){
+        for(size_t s = item.get_group(0); s < N_SEGMENTS; s += N_GROUPS){
+          const size_t begin = offset_access[s];
+          const size_t end   = offset_access[s + 1];
+
+          double partial = identity;
+          for(size_t i = begin + item.get_local_id(0); i < end; i += L){
+            partial = op(partial, A_access[i]);
+          }
+
+          const double total = sycl::reduce_over_group(item.get_group(), partial, op);
+          if(item.get_local_id(0) == 0){
+            result_access[s] = total;
+          }
+        }
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Replaces each segment of A by its inclusive or exclusive scan
+///        with the operation op, restarting at every segment
+template<typename Offset_type, typename Op_type>
+void scan_segments(sycl::queue& Q, double* A, size_t SIZE,
+                   const Offset_type* offsets, size_t N_SEGMENTS,
+                   double identity, Op_type op, bool inclusive){
+  if(SIZE == 0 || N_SEGMENTS == 0){
+    return;
+  }
+
+  const size_t L        = segment_work_group_size(Q, SIZE, N_SEGMENTS);
+  const size_t N_GROUPS = segment_group_count(N_SEGMENTS, L);
+
+  // creating a sycl scope
+  {
+    // creating buffers for the values and the offsets
+    sycl::buffer<double> A_buffer{A, sycl::range<1>{SIZE}};
+    sycl::buffer<Offset_type> offset_buffer{offsets, sycl::range<1>{N_SEGMENTS + 1}};
+
+    // executing one work-group per segment at a time in a single sycl
+    // kernel, the group walks its segment in chunks and carries the
+    // running total
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor offset_access{offset_buffer, h, sycl::read_only};
+      h.parallel_for(sycl::nd_range<1>{N_GROUPS*L, L}, [=](sycl::nd_item<1> item){
+        const auto group = item.get_group();
+        for(size_t s = item.get_group(0); s < N_SEGMENTS; s += N_GROUPS){
+          const size_t begin = offset_access[s];
+          const size_t end   = offset_access[s + 1];
+
+          double carry = identity;
+          for(size_t chunk = begin; chunk < end; chunk += L){
+            const size_t i = chunk + item.get_local_id(0);
+            const double value = i < end ? A_access[i] : identity;
+
+            const double exclusive_value = sycl::exclusive_scan_over_group(group, value, identity, op);
+            const double inclusive_value = op(exclusive_value, value);
+
+            if(i < end){
+              A_access[i] = op(carry, inclusive ? inclusive_value : exclusive_value);
+            }
+            carry = op(carry, sycl::group_broadcast(group, inclusive_value, L - 1));
+          }
+        }
+      });
+    });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Applies the operation with code op to each segment of A, using
+///        the scalar x[s] for segment s
+template<typename Offset_type>
+void apply_op_segments(sycl::queue& Q, double* A, size_t SIZE,
+                       const Offset_type* offsets, size_t N_SEGMENTS,
+                       int op, const double* x){
+  if(SIZE == 0 || N_SEGMENTS == 0){
+    return;
+  }
+
+  const size_t L        = segment_work_group_size(Q, SIZE, N_SEGMENTS);
+  const size_t N_GROUPS = segment_group_count(N_SEGMENTS, L);
+
+  // creating a sycl scope
+  {
+    // creating buffers for the values, the offsets and the scalars
+    sycl::buffer<double> A_buffer{A, sycl::range<1>{SIZE}};
+    sycl::buffer<Offset_type> offset_buffer{offsets, sycl::range<1>{N_SEGMENTS + 1}};
+    sycl::buffer<double> x_buffer{x, sycl::range<1>{N_SEGMENTS}};
+
+    // executing one work-group per segment at a time in a single sycl
+    // kernel
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor offset_access{offset_buffer, h, sycl::read_only};
+      sycl::accessor x_access{x_buffer, h, sycl::read_only};
+      h.parallel_for(sycl::nd_range<1>{N_GROUPS*L, L}, [=](sycl::nd_item<1> item){
+        for(size_t s = item.get_group(0); s < N_SEGMENTS; s += N_GROUPS){
+          const size_t begin = offset_access[s];
+          const size_t end   = offset_access[s + 1];
+          const double x_s   = x_access[s];
+
+          for(size_t i = begin + item.get_local_id(0); i < end; i += L){
+            A_access[i] = apply_vector_op(op, A_access[i], x_s);
+          }
+        }
+      });
+    });
+  }
+}
+
+/// @}
+// end "Segmented Kernels" doxygen group
+
+#endif //#ifndef SEGMENTED_KERNELS_CPP
@@ -0,0 +1,231 @@
+#ifndef SELECT_KERNELS_CPP
+#define SELECT_KERNELS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a most significant digit radix select that
+//         finds the key of a given rank without sorting
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Work-group sizes and element-wise launches
+#include "scan_kernels.cpp"
+#include "kernel_ranges.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Select Kernels
+/// \brief    Linear time selection of order statistics
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of key bits resolved in each pass
+constexpr unsigned SELECT_BITS = 8;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of histogram bins in each pass
+constexpr unsigned SELECT_BINS = 1u << SELECT_BITS;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Number of keys visited by each work-item in a histogram pass
+constexpr size_t SELECT_ITEMS_PER_WORK_ITEM = 16;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the index of prefix in the P ascending prefixes, or P
+///        when it is not one of them, usable inside sycl kernels
+template<typename Prefix_type>
+size_t find_select_prefix(const Prefix_type& prefixes, size_t P, uint64_t prefix){
+  size_t lo = 0;
+  size_t hi = P;
+  while(lo < hi){
+    const size_t mid = (lo + hi)/2;
+    if(prefixes[mid] < prefix){
+      lo = mid + 1;
+    }
+    else{
+      hi = mid;
+    }
+  }
+  return lo < P && prefixes[lo] == prefix ? lo : P;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the keys with the given ascending ranks among the first
+///        N keys, the ranks must be sorted and below N
+///
+/// All ranks are refined together. Each pass builds one histogram of the
+/// next 8 bits per distinct prefix resolved so far, over the keys that
+/// match any of them, using work-group local bins merged into global bins
+/// with atomics. Only the bins are read back to pick the digit of each
+/// rank. Once the matching keys are a small fraction of the candidates
+/// they are moved to a smaller buffer, so after the first one or two
+/// passes the remaining passes touch very little memory, and k ranks cost
+/// about as many passes over memory as one.
+inline std::vector<uint64_t> radix_select_buffer(sycl::queue& Q, sycl::buffer<uint64_t>& keys,
+                                                 size_t N, const std::vector<size_t>& ranks){
+  const size_t L = scan_work_group_size(Q);
+  const size_t LOCAL_BYTES = Q.get_device().get_info<sycl::info::device::local_mem_size>()/2;
+
+  std::unique_ptr<sycl::buffer<uint64_t>> compacted;
+  sycl::buffer<uint64_t>* candidates = &keys;
+  size_t n = N;
+
+  // distinct prefixes in ascending order, and for each rank its prefix
+  // and its rank among the keys with that prefix
+  std::vector<uint64_t> prefixes{0};
+  std::vector<size_t> group(ranks.size(), 0);
+  std::vector<size_t> remaining(ranks.begin(), ranks.end());
+  uint64_t prefix_mask = 0;
+
+  for(int shift = 64 - SELECT_BITS; shift >= 0 && !ranks.empty(); shift -= SELECT_BITS){
+    const size_t TILE    = L*SELECT_ITEMS_PER_WORK_ITEM;
+    const size_t N_TILES = (n + TILE - 1)/TILE;
+    const size_t P       = prefixes.size();
+    const size_t N_BINS  = P*SELECT_BINS;
+    const bool privatized = N_BINS*sizeof(uint32_t) <= LOCAL_BYTES;
+
+    // the buffers are released before prefixes is replaced, since the
+    // prefix buffer reads from its host memory
+    std::vector<uint64_t> next_prefixes;
+    size_t count = 0;
+    {
+      sycl::buffer<uint64_t> bin_buffer{sycl::range<1>{N_BINS}};
+      sycl::buffer<uint64_t> prefix_buffer{static_cast<const uint64_t*>(prefixes.data()), sycl::range<1>{P}};
+
+      // clearing the global bins
+      Q.submit([&](sycl::handler &h){
+        sycl::accessor bin_access{bin_buffer, h, sycl::write_only, sycl::no_init};
+        h.fill(bin_access, uint64_t(0));
+      });
+
+      // counting the next digit of the candidates that match a prefix
+      Q.submit([&](sycl::handler &h){
+        // creating device accessors
+        sycl::accessor key_access{*candidates, h, sycl::read_only};
+        sycl::accessor prefix_access{prefix_buffer, h, sycl::read_only};
+        sycl::accessor bin_access{bin_buffer, h};
+        sycl::local_accessor<uint32_t> local_bins{sycl::range<1>{privatized ? N_BINS : 1}, h};
+        h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+          const auto work_group = item.get_group();
+          const size_t local = item.get_local_id(0);
+          const size_t begin = item.get_group(0)*TILE;
+
+          if(privatized){
+            for(size_t b = local; b < N_BINS; b += L){
+              local_bins[b] = 0;
+            }
+            sycl::group_barrier(work_group);
+          }
+
+          for(size_t i = begin + local; i < sycl::min(begin + TILE, n); i += L){
+            const uint64_t key = key_access[i];
+            const size_t g = find_select_prefix(prefix_access, P, key & prefix_mask);
+            if(g == P){
+              continue;
+            }
+            const size_t b = g*SELECT_BINS + ((key >> shift) & (SELECT_BINS - 1));
+            if(privatized){
+              sycl::atomic_ref<uint32_t, sycl::memory_order::relaxed, sycl::memory_scope::work_group,
+                               sycl::access::address_space::local_space> bin{local_bins[b]};
+              bin.fetch_add(1u);
+            }
+            else{
+              sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                               sycl::access::address_space::global_space> bin{bin_access[b]};
+              bin.fetch_add(uint64_t(1));
+            }
+          }
+
+          if(privatized){
+            sycl::group_barrier(work_group);
+            for(size_t b = local; b < N_BINS; b += L){
+              if(local_bins[b] != 0){
+                sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                                 sycl::access::address_space::global_space> bin{bin_access[b]};
+                bin.fetch_add(static_cast<uint64_t>(local_bins[b]));
+              }
+            }
+          }
+        });
+      });
+
+      // picking the digit that holds each rank, the ranks are sorted so the
+      // new prefixes come out sorted too
+      sycl::host_accessor bin_access{bin_buffer, sycl::read_only};
+      for(size_t r = 0; r < ranks.size(); ++r){
+        const size_t first = group[r]*SELECT_BINS;
+        uint64_t digit = 0;
+        for(digit = 0; digit < SELECT_BINS; ++digit){
+          if(remaining[r] < bin_access[first + digit]){
+            break;
+          }
+          remaining[r] -= bin_access[first + digit];
+        }
+
+        const uint64_t prefix = prefixes[group[r]] | (digit << shift);
+        if(next_prefixes.empty() || next_prefixes.back() != prefix){
+          next_prefixes.push_back(prefix);
+          count += bin_access[first + digit];
+        }
+        group[r] = next_prefixes.size() - 1;
+      }
+    }
+    prefixes     = std::move(next_prefixes);
+    prefix_mask |= uint64_t(SELECT_BINS - 1) << shift;
+
+    if(shift == 0){
+      break;
+    }
+
+    // moving the keys that match a prefix to a smaller buffer once they
+    // are few
+    if(count <= n/8){
+      const size_t NEXT_P = prefixes.size();
+      auto next = std::make_unique<sycl::buffer<uint64_t>>(sycl::range<1>{std::max<size_t>(count, 1)});
+      sycl::buffer<uint64_t> next_prefix_buffer{static_cast<const uint64_t*>(prefixes.data()), sycl::range<1>{NEXT_P}};
+      sycl::buffer<uint64_t> counter_buffer{sycl::range<1>{1}};
+
+      Q.submit([&](sycl::handler &h){
+        sycl::accessor counter_access{counter_buffer, h, sycl::write_only, sycl::no_init};
+        h.fill(counter_access, uint64_t(0));
+      });
+
+      Q.submit([&](sycl::handler &h){
+        // creating device accessors
+        sycl::accessor key_access{*candidates, h, sycl::read_only};
+        sycl::accessor prefix_access{next_prefix_buffer, h, sycl::read_only};
+        sycl::accessor next_access{*next, h, sycl::write_only, sycl::no_init};
+        sycl::accessor counter_access{counter_buffer, h};
+        parallel_for_each(h, n, [=](size_t idx){
+          const uint64_t key = key_access[idx];
+          if(find_select_prefix(prefix_access, NEXT_P, key & prefix_mask) != NEXT_P){
+            sycl::atomic_ref<uint64_t, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                             sycl::access::address_space::global_space> counter{counter_access[0]};
+            next_access[counter.fetch_add(uint64_t(1))] = key;
+          }
+        });
+      });
+
+      compacted = std::move(next);
+      candidates = compacted.get();
+      n = count;
+    }
+  }
+
+  std::vector<uint64_t> selected(ranks.size());
+  for(size_t r = 0; r < ranks.size(); ++r){
+    selected[r] = prefixes[group[r]];
+  }
+  return selected;
+}
+
+/// @}
+// end "Select Kernels" doxygen group
+
+#endif //#ifndef SELECT_KERNELS_CPP
@@ -0,0 +1,586 @@
+#ifndef STREAM_PIPELINE_CPP
+#define STREAM_PIPELINE_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a streaming pipeline that runs an op chain and
+//         running reductions over chunks of NumPy data on its own thread
+///////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+
+// Pybind11
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Operation codes, shared storage, launches, reductions and histograms
+#include "vector_ops.cpp"
+#include "vector_storage.cpp"
+#include "kernel_ranges.cpp"
+#include "reduce_kernels.cpp"
+#include "histogram_kernels.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Stream
+/// \brief    Streams chunks of data through an op chain and reductions
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Default number of chunks that may wait for the device
+constexpr size_t STREAM_CAPACITY = 4;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reduces each tile of reduce_tile_size(Q) elements of the first N
+///        elements of data to its sum, minimum and maximum in one pass,
+///        writing tile t to partials[t], partials[N_TILES + t] and
+///        partials[2*N_TILES + t]
+inline void stream_stats_tiles(sycl::queue& Q, sycl::buffer<double>& data, size_t N,
+                               sycl::buffer<double>& partials){
+  const size_t L       = scan_work_group_size(Q);
+  const size_t TILE    = L*REDUCE_CHUNKS_PER_TILE;
+  const size_t N_TILES = (N + TILE - 1)/TILE;
+  constexpr double INF = std::numeric_limits<double>::infinity();
+
+  Q.submit([&](sycl::handler &h){
+    // creating device accessors
+    sycl::accessor data_access{data, h, sycl::read_only};
+    sycl::accessor partial_access{partials, h, sycl::write_only, sycl::no_init};
+    h.parallel_for(sycl::nd_range<1>{N_TILES*L, L}, [=](sycl::nd_item<1> item){
+      const auto group   = item.get_group();
+      const size_t begin = item.get_group(0)*TILE;
+      const size_t end   = sycl::min(begin + TILE, N);
+
+      double sum = 0.0;
+      double min = INF;
+      double max = -INF;
+      for(size_t i = begin + item.get_local_id(0); i < end; i += L){
+        const double value = data_access[i];
+        sum = sum + value;
+        min = sycl::minimum<double>()(min, value);
+        max = sycl::maximum<double>()(max, value);
+      }
+
+      sum = sycl::reduce_over_group(group, sum, 0.0, sycl::plus<double>());
+      min = sycl::reduce_over_group(group, min, INF, sycl::minimum<double>());
+      max = sycl::reduce_over_group(group, max, -INF, sycl::maximum<double>());
+      if(item.get_local_id(0) == 0){
+        partial_access[item.get_group(0)]               = sum;
+        partial_access[N_TILES + item.get_group(0)]     = min;
+        partial_access[2*N_TILES + item.get_group(0)]   = max;
+      }
+    });
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief A chunk whose kernels are submitted, with the buffers that
+///        receive its results until it is retired
+struct Stream_Flight{
+  std::vector<double> chunk;
+  size_t N_TILES;
+  sycl::buffer<double> chunk_buffer;
+  sycl::buffer<double> partial_buffer;
+  sycl::buffer<double> edge_buffer;
+  sycl::buffer<int64_t> count_buffer;
+
+  Stream_Flight(std::vector<double>&& chunk_in, size_t TILE, size_t N_BINS):
+    chunk(std::move(chunk_in)), N_TILES((chunk.size() + TILE - 1)/TILE),
+    chunk_buffer{chunk.data(), sycl::range<1>{chunk.size()}},
+    partial_buffer{sycl::range<1>{3*N_TILES}},
+    edge_buffer{sycl::range<1>{1}},
+    count_buffer{sycl::range<1>{std::max<size_t>(N_BINS, 1)}}{
+    // the chunk is not needed back
+    chunk_buffer.set_write_back(false);
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Accepts chunks from Python and processes them in order on a
+///        worker thread, so the device works on one chunk while Python
+///        produces the next
+///
+/// Each chunk is copied into a queue of at most CAPACITY chunks, run
+/// through the op chain and folded into the running count, sum, minimum,
+/// maximum and histogram. Pushing into a full queue blocks with the GIL
+/// released, which holds back producers that outrun the device. The
+/// worker keeps two chunks on the device: the kernels of chunk k are
+/// submitted before chunk k - 1 is retired, so the runtime uploads one
+/// chunk while the device computes the other.
+
+class Sycl_Stream{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Selected device
+  sycl::queue Q;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Op chain applied to every chunk
+  std::vector<int> OP_CODES;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Scalars of the op chain
+  std::vector<double> X;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Device copies of the op chain, kept for the lifetime of the
+  ///        stream so that submitting a chunk never waits on them
+  std::optional<sycl::buffer<int>> OP_BUFFER;
+  std::optional<sycl::buffer<double>> X_BUFFER;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Histogram binning, no histogram when N_BINS is 0
+  Histogram_Bins BINS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Maximum number of queued chunks
+  size_t CAPACITY;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Queued chunks, oldest first
+  std::deque<std::vector<double>> CHUNKS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Processed chunks kept to be refilled by the next pushes
+  std::vector<std::vector<double>> SPARE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of chunks the worker has taken but not yet retired
+  size_t IN_FLIGHT;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Set when the worker should exit
+  bool STOP;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief First error of the worker, rethrown by push and flush
+  std::exception_ptr ERROR;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Running results over the processed chunks
+  size_t COUNT;
+  double SUM;
+  double MIN;
+  double MAX;
+  std::vector<int64_t> COUNTS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Guards everything above that the worker shares
+  std::mutex MUTEX;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Signals queued chunks and shutdown to the worker
+  std::condition_variable WORK;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Signals free queue slots and finished chunks to producers
+  std::condition_variable SPACE;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Worker thread
+  std::thread WORKER;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Submits the op chain and the reductions over one chunk
+  ///        without waiting for them
+  void submit(Stream_Flight& flight);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Waits for the kernels of a chunk and folds its results into
+  ///        the running results
+  void retire(Stream_Flight& flight);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Retires a chunk without MUTEX held, or records the error that
+  ///        stopped it, and releases its storage
+  void finish(std::unique_ptr<Stream_Flight> flight, std::exception_ptr error);
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Takes chunks off the queue until STOP is set
+  void run();
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns a processed chunk to be refilled, or an empty one,
+  ///        called with MUTEX held
+  std::vector<double> take_spare();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Queues a copy of a chunk, waits with the GIL released while
+    ///        the queue is full
+    void push(py::array_t<double, py::array::c_style> values);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Queues a copy of a chunk unless the queue is full, returns
+    ///        whether it was queued
+    bool try_push(py::array_t<double, py::array::c_style> values);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Pushes every chunk of an iterable, returns the number of
+    ///        chunks
+    size_t consume(py::iterable chunks);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of chunks queued or being processed, at
+    ///        most CAPACITY + 2
+    size_t pending();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum number of queued chunks
+    size_t capacity();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Waits until every pushed chunk is processed, rethrows the
+    ///        error of a failed chunk
+    void flush();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of elements processed
+    size_t count();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of the processed elements
+    double sum();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of the processed elements
+    double min();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of the processed elements
+    double max();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the histogram counts of the processed elements
+    py::array_t<int64_t> histogram();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that takes the op string, the queue capacity and
+    ///        N_BINS equal width bins over [lo, hi] (log spaced when
+    ///        log_scale is set), no histogram when N_BINS is 0
+    Sycl_Stream(const std::string& ops, size_t capacity = STREAM_CAPACITY,
+                size_t N_BINS = 0, double lo = 0.0, double hi = 1.0, bool log_scale = false):
+      BINS{HISTOGRAM_LINEAR, 0, 0.0, 0.0, 0.0}, CAPACITY(capacity), IN_FLIGHT(0), STOP(false),
+      COUNT(0), SUM(0.0), MIN(std::numeric_limits<double>::infinity()),
+      MAX(-std::numeric_limits<double>::infinity()){
+      if(CAPACITY == 0){
+        throw std::invalid_argument("capacity must be positive");
+      }
+      parse_vector_ops(ops, OP_CODES, X);
+      if(!OP_CODES.empty()){
+        OP_BUFFER.emplace(static_cast<const int*>(OP_CODES.data()), sycl::range<1>{OP_CODES.size()});
+        X_BUFFER.emplace(static_cast<const double*>(X.data()), sycl::range<1>{X.size()});
+      }
+      if(N_BINS > 0){
+        BINS = make_histogram_bins(N_BINS, lo, hi, log_scale);
+        COUNTS.assign(N_BINS, 0);
+      }
+      WORKER = std::thread([this](){ run(); });
+    }
+
+    Sycl_Stream(const Sycl_Stream&) = delete;
+    Sycl_Stream& operator=(const Sycl_Stream&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Destructor that drops the queued chunks and stops the worker
+    ~Sycl_Stream(){
+      {
+        std::lock_guard<std::mutex> lock(MUTEX);
+        STOP = true;
+        CHUNKS.clear();
+      }
+      WORK.notify_one();
+      WORKER.join();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::submit(Stream_Flight& flight){
+  const size_t N = flight.chunk.size();
+
+  if(!OP_CODES.empty()){
+    const size_t N_OPS = OP_CODES.size();
+
+    // executing a single sycl kernel for the whole chain
+    Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor chunk_access{flight.chunk_buffer, h};
+      sycl::accessor op_access{*OP_BUFFER, h, sycl::read_only};
+      sycl::accessor x_access{*X_BUFFER, h, sycl::read_only};
+      parallel_for_each(h, N, [=](size_t idx){
+        double value = chunk_access[idx];
+        for(size_t k = 0; k < N_OPS; ++k){
+          value = apply_vector_op(op_access[k], value, x_access[k]);
+        }
+        chunk_access[idx] = value;
+      });
+    });
+  }
+
+  stream_stats_tiles(Q, flight.chunk_buffer, N, flight.partial_buffer);
+
+  if(BINS.N_BINS > 0){
+    Q.submit([&](sycl::handler &h){
+      sycl::accessor count_access{flight.count_buffer, h, sycl::write_only, sycl::no_init};
+      h.fill(count_access, int64_t(0));
+    });
+    histogram_buffer(Q, flight.chunk_buffer, N, BINS, flight.edge_buffer, flight.count_buffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::retire(Stream_Flight& flight){
+  // the tile partials are combined in order, so the results do not depend
+  // on scheduling
+  double sum = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  {
+    sycl::host_accessor partial_access{flight.partial_buffer, sycl::read_only};
+    for(size_t t = 0; t < flight.N_TILES; ++t){
+      sum += partial_access[t];
+      min  = sycl::minimum<double>()(min, partial_access[flight.N_TILES + t]);
+      max  = sycl::maximum<double>()(max, partial_access[2*flight.N_TILES + t]);
+    }
+  }
+
+  std::vector<int64_t> counts(BINS.N_BINS, 0);
+  if(BINS.N_BINS > 0){
+    sycl::host_accessor count_access{flight.count_buffer, sycl::read_only};
+    for(size_t b = 0; b < BINS.N_BINS; ++b){
+      counts[b] = count_access[b];
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(MUTEX);
+  COUNT += flight.chunk.size();
+  SUM   += sum;
+  MIN    = std::min(MIN, min);
+  MAX    = std::max(MAX, max);
+  for(size_t b = 0; b < counts.size(); ++b){
+    COUNTS[b] += counts[b];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::finish(std::unique_ptr<Stream_Flight> flight, std::exception_ptr error){
+  std::vector<double> chunk;
+  if(flight){
+    if(!error){
+      try{
+        retire(*flight);
+      }
+      catch(...){
+        error = std::current_exception();
+      }
+    }
+    // the storage outlives the chunk buffer, which waits for its kernels
+    chunk = std::move(flight->chunk);
+    flight.reset();
+  }
+
+  std::lock_guard<std::mutex> lock(MUTEX);
+  --IN_FLIGHT;
+  if(error && !ERROR){
+    ERROR = error;
+    CHUNKS.clear();
+  }
+  if(SPARE.size() < CAPACITY){
+    SPARE.push_back(std::move(chunk));
+  }
+  SPACE.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::run(){
+  const size_t TILE = reduce_tile_size(Q);
+  std::unique_ptr<Stream_Flight> previous;
+  std::unique_lock<std::mutex> lock(MUTEX);
+  while(true){
+    if(previous && CHUNKS.empty() && !STOP){
+      // no chunk to overlap with, so the one on the device is retired
+      // before waiting for more
+      lock.unlock();
+      finish(std::move(previous), nullptr);
+      lock.lock();
+      continue;
+    }
+    WORK.wait(lock, [this](){ return STOP || !CHUNKS.empty(); });
+    if(STOP){
+      return;
+    }
+    std::vector<double> chunk = std::move(CHUNKS.front());
+    CHUNKS.pop_front();
+    if(chunk.empty()){
+      SPACE.notify_all();
+      continue;
+    }
+    ++IN_FLIGHT;
+    lock.unlock();
+    // a slot is free as soon as the chunk leaves the queue
+    SPACE.notify_all();
+
+    std::unique_ptr<Stream_Flight> current;
+    std::exception_ptr error;
+    try{
+      current = std::make_unique<Stream_Flight>(std::move(chunk), TILE, BINS.N_BINS);
+      submit(*current);
+    }
+    catch(...){
+      error = std::current_exception();
+    }
+
+    // the previous chunk is retired while the device works on this one
+    if(previous){
+      finish(std::move(previous), nullptr);
+    }
+    if(error){
+      finish(std::move(current), error);
+    }
+    else{
+      previous = std::move(current);
+    }
+    lock.lock();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Stream::take_spare(){
+  std::vector<double> chunk;
+  if(!SPARE.empty()){
+    chunk = std::move(SPARE.back());
+    SPARE.pop_back();
+  }
+  return chunk;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::push(py::array_t<double, py::array::c_style> values){
+  // copying with the GIL held, the array may change once it is released
+  std::vector<double> chunk;
+  {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    chunk = take_spare();
+  }
+  chunk.assign(values.data(), values.data() + values.size());
+
+  // waiting without the GIL so the worker and other Python threads run,
+  // MUTEX is never held while the GIL is taken back
+  py::gil_scoped_release release;
+  std::unique_lock<std::mutex> lock(MUTEX);
+  SPACE.wait(lock, [this](){ return ERROR || CHUNKS.size() < CAPACITY; });
+  if(ERROR){
+    std::rethrow_exception(ERROR);
+  }
+  CHUNKS.push_back(std::move(chunk));
+  lock.unlock();
+  WORK.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////
+bool Sycl_Stream::try_push(py::array_t<double, py::array::c_style> values){
+  {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    if(ERROR){
+      std::rethrow_exception(ERROR);
+    }
+    if(CHUNKS.size() >= CAPACITY){
+      return false;
+    }
+    CHUNKS.push_back(take_spare());
+    CHUNKS.back().assign(values.data(), values.data() + values.size());
+  }
+  WORK.notify_one();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Stream::consume(py::iterable chunks){
+  size_t n = 0;
+  for(py::handle chunk : chunks){
+    push(chunk.cast<py::array_t<double, py::array::c_style>>());
+    ++n;
+  }
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Stream::pending(){
+  std::lock_guard<std::mutex> lock(MUTEX);
+  return CHUNKS.size() + IN_FLIGHT;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Stream::capacity(){
+  return CAPACITY;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Stream::flush(){
+  std::unique_lock<std::mutex> lock(MUTEX);
+  SPACE.wait(lock, [this](){ return CHUNKS.empty() && IN_FLIGHT == 0; });
+  if(ERROR){
+    std::rethrow_exception(ERROR);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Stream::count(){
+  flush();
+  std::lock_guard<std::mutex> lock(MUTEX);
+  return COUNT;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Stream::sum(){
+  flush();
+  std::lock_guard<std::mutex> lock(MUTEX);
+  return SUM;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Stream::min(){
+  flush();
+  std::lock_guard<std::mutex> lock(MUTEX);
+  return MIN;
+}
+
+////////////////////////////////////////////////////////////////////////
+double Sycl_Stream::max(){
+  flush();
+  std::lock_guard<std::mutex> lock(MUTEX);
+  return MAX;
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<int64_t> Sycl_Stream::histogram(){
+  {
+    // waiting without the GIL like the other results, the array is built
+    // once it is taken back
+    py::gil_scoped_release release;
+    flush();
+  }
+  std::lock_guard<std::mutex> lock(MUTEX);
+  std::shared_ptr<int64_t> counts = allocate_storage<int64_t>(COUNTS.size(), false, COUNTS.data());
+  return share_storage(counts, COUNTS.size());
+}
+
+/// @}
+// end "Sycl Stream" doxygen group
+
+#endif //#ifndef STREAM_PIPELINE_CPP
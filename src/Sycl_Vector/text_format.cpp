@@ -0,0 +1,205 @@
+#ifndef TEXT_FORMAT_CPP
+#define TEXT_FORMAT_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a parallel parser for numbers in delimited or
+//         whitespace separated text files
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+// File mappings
+#include <sys/mman.h>
+
+// File I/O and the task pool
+#include "vector_io.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Text Format
+/// \brief    Parallel parsing of numeric text
+/// @{
+///////////////////////////////////////////////////////////////////////////
+///
+/// Values are separated by whitespace, line breaks and an optional
+/// delimiter character, so the same parser reads CSV and whitespace
+/// separated files. A delimiter must follow a value, empty fields are
+/// errors. Text from the comment character to the end of the line is
+/// ignored.
+///
+/// The file is split into segments that start after a line break and
+/// parsed in two passes: the first counts the values of each segment,
+/// which gives each segment its offset in the vector, the second parses
+/// the values straight into the vector storage.
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Nominal number of bytes per segment, a segment ends at the
+///        first line break after it
+constexpr size_t TEXT_SEGMENT_BYTES = size_t(1) << 22;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Segments of a text file and the index of their first value
+struct Text_Segments{
+  std::vector<size_t> begin;
+  std::vector<size_t> first_value;
+  size_t SIZE;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the character of a one character option, or '\0' when
+///        empty
+inline char text_option(const std::string& value, const std::string& name){
+  if(value.size() > 1){
+    throw std::invalid_argument(name + " must be a single character");
+  }
+  if(value == "\n" || value == "\r" || value == " " || value == "\t"){
+    throw std::invalid_argument(name + " cannot be whitespace");
+  }
+  return value.empty() ? '\0' : value[0];
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Maps BYTES bytes of the file fd read only, the mapping is
+///        released with the last reference
+inline std::shared_ptr<const char> map_text_file(int fd, size_t BYTES){
+  if(BYTES == 0){
+    return std::shared_ptr<const char>();
+  }
+  void* data = mmap(nullptr, BYTES, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(data == MAP_FAILED){
+    throw std::runtime_error(std::string("cannot map text file: ") + std::strerror(errno));
+  }
+  return std::shared_ptr<const char>(static_cast<const char*>(data), [BYTES](const char* p){
+    munmap(const_cast<char*>(p), BYTES);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Throws a parse error that names the line of position in text
+[[noreturn]] inline void text_error(const char* text, size_t position, const std::string& what){
+  const size_t LINE = 1 + std::count(text, text + position, '\n');
+  throw std::invalid_argument("line " + std::to_string(LINE) + ": " + what);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Scans text[begin, end) and returns the number of values, which
+///        are also parsed into values when PARSE is set
+template<bool PARSE>
+size_t scan_text(const char* text, size_t begin, size_t end, char delimiter, char comment, double* values){
+  size_t count = 0;
+  bool after_value = false;
+  bool open_field  = false;
+  const char* p    = text + begin;
+  const char* last = text + end;
+  while(p < last){
+    const char c = *p;
+    if(c == ' ' || c == '\t' || c == '\r'){
+      ++p;
+    }
+    else if(c == '\n'){
+      if(open_field){
+        text_error(text, p - text, "empty field at the end of the line");
+      }
+      after_value = false;
+      ++p;
+    }
+    else if(c == comment && comment != '\0'){
+      // stopping at the line break so an open field is still caught
+      const void* line_end = std::memchr(p, '\n', last - p);
+      p = line_end == nullptr ? last : static_cast<const char*>(line_end);
+    }
+    else if(c == delimiter && delimiter != '\0'){
+      if(!after_value){
+        text_error(text, p - text, "empty field");
+      }
+      after_value = false;
+      open_field  = true;
+      ++p;
+    }
+    else{
+      const char* token = p;
+      while(p < last && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'
+            && (*p != delimiter || delimiter == '\0') && (*p != comment || comment == '\0')){
+        ++p;
+      }
+      if(PARSE){
+        // from_chars takes no leading '+'
+        const char* first = *token == '+' && p - token > 1 ? token + 1 : token;
+        const std::from_chars_result result = std::from_chars(first, p, values[count]);
+        if(result.ec == std::errc::result_out_of_range && result.ptr == p){
+          // overflow to infinity and underflow to zero, as strtod does
+          values[count] = std::strtod(std::string(first, p).c_str(), nullptr);
+        }
+        else if(result.ec != std::errc() || result.ptr != p){
+          text_error(text, token - text, "cannot parse '" + std::string(token, p) + "' as a number");
+        }
+      }
+      after_value = true;
+      open_field  = false;
+      ++count;
+    }
+  }
+  if(open_field){
+    text_error(text, end, "empty field at the end of the line");
+  }
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Splits the text after its first skip_rows lines into segments
+///        and counts their values in parallel
+inline Text_Segments split_text(const char* text, size_t BYTES, size_t skip_rows, char delimiter, char comment){
+  size_t start = 0;
+  for(size_t row = 0; row < skip_rows && start < BYTES; ++row){
+    const void* line_end = std::memchr(text + start, '\n', BYTES - start);
+    start = line_end == nullptr ? BYTES : static_cast<const char*>(line_end) - text + 1;
+  }
+
+  Text_Segments segments{{}, {}, 0};
+  for(size_t nominal = start; nominal < BYTES; nominal += TEXT_SEGMENT_BYTES){
+    size_t begin = nominal;
+    if(nominal != start){
+      const void* line_end = std::memchr(text + nominal - 1, '\n', BYTES - nominal + 1);
+      begin = line_end == nullptr ? BYTES : static_cast<const char*>(line_end) - text + 1;
+    }
+    // long lines can swallow the following nominal segments
+    if(segments.begin.empty() || begin > segments.begin.back()){
+      segments.begin.push_back(begin);
+    }
+  }
+  segments.begin.push_back(BYTES);
+
+  const size_t N_SEGMENTS = segments.begin.size() - 1;
+  std::vector<size_t> counts(N_SEGMENTS);
+  run_parallel(N_SEGMENTS, [&](size_t s){
+    counts[s] = scan_text<false>(text, segments.begin[s], segments.begin[s + 1], delimiter, comment, nullptr);
+  });
+
+  segments.first_value.resize(N_SEGMENTS);
+  for(size_t s = 0; s < N_SEGMENTS; ++s){
+    segments.first_value[s] = segments.SIZE;
+    segments.SIZE += counts[s];
+  }
+  return segments;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Parses the values of the segments into values in parallel
+inline void parse_text(const char* text, const Text_Segments& segments, char delimiter, char comment, double* values){
+  run_parallel(segments.first_value.size(), [&](size_t s){
+    scan_text<true>(text, segments.begin[s], segments.begin[s + 1], delimiter, comment,
+                    values + segments.first_value[s]);
+  });
+}
+
+/// @}
+// end "Text Format" doxygen group
+
+#endif //#ifndef TEXT_FORMAT_CPP
@@ -0,0 +1,269 @@
+#ifndef VECTOR_BATCH_CPP
+#define VECTOR_BATCH_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing a batch of vectors stored in one contiguous
+//         arena so that operations run as a single kernel over all vectors
+///////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+// Operation codes
+#include "vector_ops.cpp"
+
+// Shared storage
+#include "vector_storage.cpp"
+
+// Segmented kernels
+#include "segmented_kernels.cpp"
+
+// Element-wise launches and kernel timing
+#include "kernel_ranges.cpp"
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Sycl Vector Batch
+/// \brief    Creates a batch of sycl based vectors of varying lengths
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Holds many vectors in one arena with an offsets table
+
+class Sycl_Vector_Batch{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Selected device
+  sycl::queue Q;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of vectors in the batch
+  size_t N_VECTORS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Start of each vector in the arena, the last entry is the
+  ///        total number of elements
+  std::vector<size_t> OFFSETS;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Arena holding the elements of all vectors
+  std::shared_ptr<double> A;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Reduces each vector with the operation op in a single kernel
+  template<typename Op_type>
+  std::vector<double> reduce_each_vector(double identity, Op_type op);
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of vectors in the batch
+    size_t size();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Enables or disables kernel profiling on the selected device
+    void enable_profiling(bool enable);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Adds some value x to each element of every vector
+    template<typename Scalar_type>
+    void add_each_element(Scalar_type x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Subtracts some value x from each element of every vector
+    template<typename Scalar_type>
+    void subtract_each_element(Scalar_type x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Multiplies each element of every vector by some value x
+    template<typename Scalar_type>
+    void multiply_each_element(Scalar_type x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Divides each element of every vector by some value x
+    template<typename Scalar_type>
+    void divide_each_element(Scalar_type x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Applies a chain of operations to every element of every
+    ///        vector in a single kernel, returns the kernel time in seconds
+    ///        when profiling is enabled
+    std::optional<double> apply_batch(const std::vector<int>& op_codes,
+                                      const std::vector<double>& x);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the sum of each vector
+    std::vector<double> sum_each_vector();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the minimum of each vector
+    std::vector<double> min_each_vector();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the maximum of each vector
+    std::vector<double> max_each_vector();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the vector at index i
+    std::vector<double> get_vector(size_t i);
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a NumPy array that shares the arena of all vectors
+    py::array_t<double> get_arena();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the offsets table
+    std::vector<size_t> get_offsets();
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that initializes zero vectors of the given sizes
+    Sycl_Vector_Batch(const std::vector<size_t>& sizes): N_VECTORS(sizes.size()){
+      OFFSETS.reserve(N_VECTORS + 1);
+      OFFSETS.push_back(0);
+      for(size_t n : sizes){
+        OFFSETS.push_back(OFFSETS.back() + n);
+      }
+      A = allocate_storage<double>(OFFSETS.back());
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that copies the given vectors into the arena
+    Sycl_Vector_Batch(const std::vector<std::vector<double>>& vectors): N_VECTORS(vectors.size()){
+      OFFSETS.reserve(N_VECTORS + 1);
+      OFFSETS.push_back(0);
+      for(const auto& v : vectors){
+        OFFSETS.push_back(OFFSETS.back() + v.size());
+      }
+      A = allocate_storage<double>(OFFSETS.back());
+      for(size_t i = 0; i < N_VECTORS; ++i){
+        std::copy(vectors[i].begin(), vectors[i].end(), A.get() + OFFSETS[i]);
+      }
+    }
+};
+
+/// @}
+// end "Sycl Vector Batch" doxygen group
+
+////////////////////////////////////////////////////////////////////////
+template<typename Op_type>
+std::vector<double> Sycl_Vector_Batch::reduce_each_vector(double identity, Op_type op){
+  std::vector<double> result(N_VECTORS);
+  reduce_segments(Q, A.get(), OFFSETS.back(), OFFSETS.data(), N_VECTORS, identity, op, result.data());
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+size_t Sycl_Vector_Batch::size(){
+  return N_VECTORS;
+}
+
+////////////////////////////////////////////////////////////////////////
+void Sycl_Vector_Batch::enable_profiling(bool enable){
+  set_queue_profiling(Q, enable);
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Scalar_type>
+void Sycl_Vector_Batch::add_each_element(Scalar_type x){
+  apply_batch({VECTOR_OP_ADD}, {static_cast<double>(x)});
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Scalar_type>
+void Sycl_Vector_Batch::subtract_each_element(Scalar_type x){
+  apply_batch({VECTOR_OP_SUBTRACT}, {static_cast<double>(x)});
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Scalar_type>
+void Sycl_Vector_Batch::multiply_each_element(Scalar_type x){
+  apply_batch({VECTOR_OP_MULTIPLY}, {static_cast<double>(x)});
+}
+
+////////////////////////////////////////////////////////////////////////
+template<typename Scalar_type>
+void Sycl_Vector_Batch::divide_each_element(Scalar_type x){
+  apply_batch({VECTOR_OP_DIVIDE}, {static_cast<double>(x)});
+}
+
+////////////////////////////////////////////////////////////////////////
+std::optional<double> Sycl_Vector_Batch::apply_batch(const std::vector<int>& op_codes,
+                                                     const std::vector<double>& x){
+  check_vector_ops(op_codes, x);
+
+  const size_t SIZE = OFFSETS.back();
+  if(op_codes.empty() || SIZE == 0){
+    return std::nullopt;
+  }
+
+  const size_t N_OPS = op_codes.size();
+  sycl::event kernel_event;
+
+  // creating a sycl scope
+  {
+    // creating buffers for the arena and the op chain
+    sycl::buffer<double> A_buffer{A.get(), sycl::range<1>{SIZE}};
+    sycl::buffer<int> op_buffer{op_codes.data(), sycl::range<1>{N_OPS}};
+    sycl::buffer<double> x_buffer{x.data(), sycl::range<1>{N_OPS}};
+
+    // executing a single sycl kernel over the elements of all vectors
+    kernel_event = Q.submit([&](sycl::handler &h){
+      // creating device accessors
+      sycl::accessor A_access{A_buffer, h};
+      sycl::accessor op_access{op_buffer, h, sycl::read_only};
+      sycl::accessor x_access{x_buffer, h, sycl::read_only};
+      parallel_for_each(h, SIZE, [=](size_t idx){
+        double value = A_access[idx];
+        for(size_t k = 0; k < N_OPS; ++k){
+          value = apply_vector_op(op_access[k], value, x_access[k]);
+        }
+        A_access[idx] = value;
+      });
+    });
+  }
+
+  return kernel_event_time(Q, kernel_event);
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Vector_Batch::sum_each_vector(){
+  return reduce_each_vector(0.0, sycl::plus<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Vector_Batch::min_each_vector(){
+  return reduce_each_vector(std::numeric_limits<double>::infinity(), sycl::minimum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Vector_Batch::max_each_vector(){
+  return reduce_each_vector(-std::numeric_limits<double>::infinity(), sycl::maximum<double>());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<double> Sycl_Vector_Batch::get_vector(size_t i){
+  if(i >= N_VECTORS){
+    throw std::out_of_range("vector index out of range");
+  }
+  return std::vector<double>(A.get() + OFFSETS[i], A.get() + OFFSETS[i + 1]);
+}
+
+////////////////////////////////////////////////////////////////////////
+py::array_t<double> Sycl_Vector_Batch::get_arena(){
+  return share_storage(A, OFFSETS.back());
+}
+
+////////////////////////////////////////////////////////////////////////
+std::vector<size_t> Sycl_Vector_Batch::get_offsets(){
+  return OFFSETS;
+}
+
+#endif //#ifndef VECTOR_BATCH_CPP
@@ -0,0 +1,256 @@
+#ifndef VECTOR_CODECS_CPP
+#define VECTOR_CODECS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the lossless codecs that compress the chunks
+//         of the chunked vector format, one chunk per call so the chunks
+//         can be coded in parallel
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Optional general purpose compressors, enabled by the build
+#ifdef SYCL_VECTOR_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef SYCL_VECTOR_WITH_LZ4
+#include <lz4.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Vector Codecs
+/// \brief    Lossless compression of float64 chunks
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Codes of the chunk codecs, stored in the chunked format
+enum Vector_Codec : uint32_t {
+  VECTOR_CODEC_RAW          = 0,
+  VECTOR_CODEC_XOR          = 1,
+  VECTOR_CODEC_SHUFFLE_LZ4  = 2,
+  VECTOR_CODEC_SHUFFLE_ZSTD = 3,
+  VECTOR_CODEC_COUNT
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Compression level of the zstd codec, low levels keep the codec
+///        close to disk speed
+constexpr int VECTOR_CODEC_ZSTD_LEVEL = 1;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns true when the build includes the codec
+inline bool vector_codec_available(uint32_t codec){
+  switch(codec){
+    case VECTOR_CODEC_RAW:
+    case VECTOR_CODEC_XOR:
+      return true;
+#ifdef SYCL_VECTOR_WITH_LZ4
+    case VECTOR_CODEC_SHUFFLE_LZ4:
+      return true;
+#endif
+#ifdef SYCL_VECTOR_WITH_ZSTD
+    case VECTOR_CODEC_SHUFFLE_ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the codec for a name ("raw", "xor", "shuffle_lz4" or
+///        "shuffle_zstd"), throws for codecs missing from the build
+inline uint32_t vector_codec_from_name(const std::string& name){
+  const char* NAMES[] = {"raw", "xor", "shuffle_lz4", "shuffle_zstd"};
+  for(uint32_t codec = 0; codec < VECTOR_CODEC_COUNT; ++codec){
+    if(name == NAMES[codec]){
+      if(!vector_codec_available(codec)){
+        throw std::invalid_argument("codec '" + name + "' is not included in this build");
+      }
+      return codec;
+    }
+  }
+  throw std::invalid_argument("unknown codec '" + name + "'");
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Writes byte k of each of the N values to plane k of bytes, so
+///        the slowly changing sign and exponent bytes end up next to each
+///        other for the general purpose compressors
+inline void byte_shuffle(const double* values, size_t N, char* bytes){
+  const char* in = reinterpret_cast<const char*>(values);
+  for(size_t i = 0; i < N; ++i){
+    for(size_t k = 0; k < sizeof(double); ++k){
+      bytes[k*N + i] = in[i*sizeof(double) + k];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Inverse of byte_shuffle
+inline void byte_unshuffle(const char* bytes, size_t N, double* values){
+  char* out = reinterpret_cast<char*>(values);
+  for(size_t i = 0; i < N; ++i){
+    for(size_t k = 0; k < sizeof(double); ++k){
+      out[i*sizeof(double) + k] = bytes[k*N + i];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Encodes N values by XOR with the previous value
+///
+/// Neighbouring values of smooth data share the sign, the exponent and
+/// the top of the mantissa, and integral values end in zero bytes, so
+/// the XOR has leading and trailing zero bytes. One control byte per
+/// value holds their counts (leading in the high nibble), followed after
+/// all control bytes by the remaining middle bytes.
+inline std::string xor_encode(const double* values, size_t N){
+  std::string bytes(N, '\0');
+  bytes.reserve(N*(1 + sizeof(double)));
+
+  uint64_t previous = 0;
+  for(size_t i = 0; i < N; ++i){
+    uint64_t bits;
+    std::memcpy(&bits, values + i, sizeof(bits));
+    const uint64_t x = bits ^ previous;
+    previous = bits;
+
+    const int leading  = x == 0 ? 8 : __builtin_clzll(x)/8;
+    const int trailing = x == 0 ? 0 : __builtin_ctzll(x)/8;
+    bytes[i] = static_cast<char>((leading << 4) | trailing);
+    for(int k = trailing; k < 8 - leading; ++k){
+      bytes += static_cast<char>(x >> (8*k));
+    }
+  }
+  return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Decodes N values written by xor_encode from BYTES bytes
+inline void xor_decode(const char* bytes, size_t BYTES, double* values, size_t N){
+  if(BYTES < N){
+    throw std::invalid_argument("corrupt xor chunk");
+  }
+
+  size_t pos = N;
+  uint64_t previous = 0;
+  for(size_t i = 0; i < N; ++i){
+    const int control  = static_cast<unsigned char>(bytes[i]);
+    const int leading  = control >> 4;
+    const int trailing = control & 0xF;
+    if(leading + trailing > 8 || pos + (8 - leading - trailing) > BYTES){
+      throw std::invalid_argument("corrupt xor chunk");
+    }
+
+    uint64_t x = 0;
+    for(int k = trailing; k < 8 - leading; ++k){
+      x |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[pos++])) << (8*k);
+    }
+    previous ^= x;
+    std::memcpy(values + i, &previous, sizeof(previous));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns N values encoded with codec
+inline std::string encode_chunk(uint32_t codec, const double* values, size_t N){
+  const size_t BYTES = N*sizeof(double);
+  switch(codec){
+    case VECTOR_CODEC_RAW:
+      return std::string(reinterpret_cast<const char*>(values), BYTES);
+
+    case VECTOR_CODEC_XOR:
+      return xor_encode(values, N);
+
+#ifdef SYCL_VECTOR_WITH_LZ4
+    case VECTOR_CODEC_SHUFFLE_LZ4:{
+      if(BYTES > LZ4_MAX_INPUT_SIZE){
+        throw std::invalid_argument("chunk too large for lz4");
+      }
+      std::string shuffled(BYTES, '\0');
+      byte_shuffle(values, N, shuffled.data());
+      std::string bytes(LZ4_compressBound(static_cast<int>(BYTES)), '\0');
+      const int written = LZ4_compress_default(shuffled.data(), bytes.data(), static_cast<int>(BYTES),
+                                               static_cast<int>(bytes.size()));
+      if(written <= 0){
+        throw std::runtime_error("lz4 compression failed");
+      }
+      bytes.resize(written);
+      return bytes;
+    }
+#endif
+
+#ifdef SYCL_VECTOR_WITH_ZSTD
+    case VECTOR_CODEC_SHUFFLE_ZSTD:{
+      std::string shuffled(BYTES, '\0');
+      byte_shuffle(values, N, shuffled.data());
+      std::string bytes(ZSTD_compressBound(BYTES), '\0');
+      const size_t written = ZSTD_compress(bytes.data(), bytes.size(), shuffled.data(), BYTES,
+                                           VECTOR_CODEC_ZSTD_LEVEL);
+      if(ZSTD_isError(written)){
+        throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(written));
+      }
+      bytes.resize(written);
+      return bytes;
+    }
+#endif
+
+    default:
+      throw std::invalid_argument("codec " + std::to_string(codec) + " is not included in this build");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Decodes N values encoded with codec from BYTES bytes
+inline void decode_chunk(uint32_t codec, const char* bytes, size_t BYTES, double* values, size_t N){
+  const size_t VALUE_BYTES = N*sizeof(double);
+  switch(codec){
+    case VECTOR_CODEC_RAW:
+      if(BYTES != VALUE_BYTES){
+        throw std::invalid_argument("corrupt raw chunk");
+      }
+      std::memcpy(values, bytes, VALUE_BYTES);
+      return;
+
+    case VECTOR_CODEC_XOR:
+      xor_decode(bytes, BYTES, values, N);
+      return;
+
+#ifdef SYCL_VECTOR_WITH_LZ4
+    case VECTOR_CODEC_SHUFFLE_LZ4:{
+      std::string shuffled(VALUE_BYTES, '\0');
+      const int n_read = LZ4_decompress_safe(bytes, shuffled.data(), static_cast<int>(BYTES),
+                                             static_cast<int>(VALUE_BYTES));
+      if(n_read != static_cast<int>(VALUE_BYTES)){
+        throw std::invalid_argument("corrupt lz4 chunk");
+      }
+      byte_unshuffle(shuffled.data(), N, values);
+      return;
+    }
+#endif
+
+#ifdef SYCL_VECTOR_WITH_ZSTD
+    case VECTOR_CODEC_SHUFFLE_ZSTD:{
+      std::string shuffled(VALUE_BYTES, '\0');
+      const size_t n_read = ZSTD_decompress(shuffled.data(), VALUE_BYTES, bytes, BYTES);
+      if(ZSTD_isError(n_read) || n_read != VALUE_BYTES){
+        throw std::invalid_argument("corrupt zstd chunk");
+      }
+      byte_unshuffle(shuffled.data(), N, values);
+      return;
+    }
+#endif
+
+    default:
+      throw std::invalid_argument("codec " + std::to_string(codec) + " is not included in this build");
+  }
+}
+
+/// @}
+// end "Vector Codecs" doxygen group
+
+#endif //#ifndef VECTOR_CODECS_CPP
@@ -0,0 +1,365 @@
+#ifndef VECTOR_IO_CPP
+#define VECTOR_IO_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the file I/O used to save and load vectors,
+//         with one positioned read or write stream per thread
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+
+// Positioned I/O
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Vector IO
+/// \brief    Parallel positioned file I/O
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Least number of bytes handed to each I/O thread
+constexpr size_t IO_THREAD_BYTES = size_t(1) << 23;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Alignment of the addresses, offsets and lengths of O_DIRECT
+///        transfers
+constexpr size_t IO_DIRECT_ALIGNMENT = 4096;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Owns a file descriptor, an invalid descriptor is -1
+class File_Descriptor{
+  int FD;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the descriptor
+    int get() const{
+      return FD;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the size of the file in bytes
+    size_t size() const{
+      struct stat file_stat;
+      if(fstat(FD, &file_stat) != 0){
+        throw std::runtime_error(std::string("cannot stat file: ") + std::strerror(errno));
+      }
+      return static_cast<size_t>(file_stat.st_size);
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Opens path with flags, returns an invalid descriptor instead
+    ///        of throwing, for optional modes such as O_DIRECT that not
+    ///        every file system supports
+    static File_Descriptor try_open(const std::string& path, int flags){
+      File_Descriptor file;
+      file.FD = open(path.c_str(), flags | O_CLOEXEC, 0644);
+      return file;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that leaves the descriptor invalid
+    File_Descriptor(): FD(-1){}
+
+    ////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor that opens path with flags
+    File_Descriptor(const std::string& path, int flags): FD(open(path.c_str(), flags | O_CLOEXEC, 0644)){
+      if(FD < 0){
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+      }
+    }
+
+    File_Descriptor(const File_Descriptor&) = delete;
+    File_Descriptor& operator=(const File_Descriptor&) = delete;
+
+    File_Descriptor(File_Descriptor&& other): FD(other.FD){
+      other.FD = -1;
+    }
+
+    ~File_Descriptor(){
+      if(FD >= 0){
+        close(FD);
+      }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the CRC-32 (as used by zip) of BYTES bytes at data
+///        continued from crc
+inline uint32_t crc32_update(uint32_t crc, const char* data, size_t BYTES){
+  static const std::array<uint32_t, 256> TABLE = [](){
+    std::array<uint32_t, 256> table{};
+    for(uint32_t n = 0; n < 256; ++n){
+      uint32_t c = n;
+      for(int k = 0; k < 8; ++k){
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+    return table;
+  }();
+
+  crc = ~crc;
+  for(size_t i = 0; i < BYTES; ++i){
+    crc = TABLE[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the CRC-32 of two consecutive pieces from their CRCs
+///        and the length of the second, so pieces can be checked in
+///        parallel
+///
+/// Appending BYTES zero bytes is a linear map on the CRC, applied here by
+/// repeated squaring of the one-zero-bit operator as in zlib.
+inline uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t BYTES){
+  const auto times = [](const uint32_t* matrix, uint32_t vector){
+    uint32_t sum = 0;
+    for(; vector != 0; vector >>= 1, ++matrix){
+      if(vector & 1){
+        sum ^= *matrix;
+      }
+    }
+    return sum;
+  };
+  const auto square = [&](uint32_t* result, const uint32_t* matrix){
+    for(int n = 0; n < 32; ++n){
+      result[n] = times(matrix, matrix[n]);
+    }
+  };
+
+  if(BYTES == 0){
+    return crc1;
+  }
+
+  // odd holds the operator for one zero bit, even for two, then four
+  uint32_t even[32];
+  uint32_t odd[32];
+  odd[0] = 0xEDB88320u;
+  for(int n = 1; n < 32; ++n){
+    odd[n] = uint32_t(1) << (n - 1);
+  }
+  square(even, odd);
+  square(odd, even);
+
+  // applying the operator for one zero byte, two, four, ... as set in BYTES
+  do{
+    square(even, odd);
+    if(BYTES & 1){
+      crc1 = times(even, crc1);
+    }
+    BYTES >>= 1;
+    if(BYTES == 0){
+      break;
+    }
+    square(odd, even);
+    if(BYTES & 1){
+      crc1 = times(odd, crc1);
+    }
+    BYTES >>= 1;
+  }while(BYTES != 0);
+
+  return crc1 ^ crc2;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Writes BYTES bytes at data to fd at offset, returns 0 or errno
+inline int write_exact(int fd, const char* data, size_t BYTES, size_t offset){
+  while(BYTES > 0){
+    const ssize_t written = pwrite(fd, data, BYTES, static_cast<off_t>(offset));
+    if(written < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      return errno;
+    }
+    data   += written;
+    offset += static_cast<size_t>(written);
+    BYTES  -= static_cast<size_t>(written);
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reads BYTES bytes from fd at offset into data, returns 0 or
+///        errno, EIO when the file ends early
+inline int read_exact(int fd, char* data, size_t BYTES, size_t offset){
+  while(BYTES > 0){
+    const ssize_t n_read = pread(fd, data, BYTES, static_cast<off_t>(offset));
+    if(n_read < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      return errno;
+    }
+    if(n_read == 0){
+      return EIO;
+    }
+    data   += n_read;
+    offset += static_cast<size_t>(n_read);
+    BYTES  -= static_cast<size_t>(n_read);
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Splits BYTES bytes at data, going to file offset, into one piece
+///        per thread and calls transfer(fd, begin, end) for each piece in
+///        its own thread, returns the CRC-32 of the bytes when crc is set
+///
+/// When direct_fd is valid and data and offset are aligned, the aligned
+/// bulk goes through direct_fd in aligned pieces and only the tail
+/// through fd, so large transfers bypass the page cache.
+template<typename Transfer_type>
+uint32_t transfer_parallel(int fd, int direct_fd, const char* data, size_t BYTES, size_t offset,
+                           bool crc, Transfer_type transfer){
+  const bool DIRECT = direct_fd >= 0 && offset % IO_DIRECT_ALIGNMENT == 0
+                      && reinterpret_cast<uintptr_t>(data) % IO_DIRECT_ALIGNMENT == 0;
+  const size_t ALIGNMENT = DIRECT ? IO_DIRECT_ALIGNMENT : 1;
+  const size_t BULK      = BYTES/ALIGNMENT*ALIGNMENT;
+
+  const size_t N_THREADS = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+                                                                 BULK/IO_THREAD_BYTES));
+  const size_t CHUNK     = std::max<size_t>(1, (BULK/ALIGNMENT + N_THREADS - 1)/N_THREADS)*ALIGNMENT;
+
+  // the pieces in file order, the unaligned tail last
+  std::vector<size_t> bounds{0};
+  while(bounds.back() < BULK){
+    bounds.push_back(std::min(bounds.back() + CHUNK, BULK));
+  }
+  if(BULK < BYTES){
+    bounds.push_back(BYTES);
+  }
+  const size_t N_PIECES = bounds.size() - 1;
+
+  std::vector<int> errors(N_PIECES, 0);
+  std::vector<uint32_t> crcs(N_PIECES, 0);
+  std::vector<std::thread> threads;
+  threads.reserve(N_PIECES);
+  for(size_t p = 0; p < N_PIECES; ++p){
+    threads.emplace_back([&, p](){
+      const size_t begin = bounds[p];
+      const size_t end   = bounds[p + 1];
+      errors[p] = transfer(end <= BULK && DIRECT ? direct_fd : fd, begin, end);
+      if(crc && errors[p] == 0){
+        crcs[p] = crc32_update(0, data + begin, end - begin);
+      }
+    });
+  }
+  for(auto& thread : threads){
+    thread.join();
+  }
+
+  uint32_t result = 0;
+  for(size_t p = 0; p < N_PIECES; ++p){
+    if(errors[p] != 0){
+      throw std::runtime_error(std::string("file I/O failed: ") + std::strerror(errors[p]));
+    }
+    result = crc32_combine(result, crcs[p], bounds[p + 1] - bounds[p]);
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Writes BYTES bytes at data to the file at offset with one
+///        pwrite stream per thread, returns their CRC-32 when crc is set
+inline uint32_t write_parallel(int fd, int direct_fd, const char* data, size_t BYTES, size_t offset,
+                               bool crc = false){
+  return transfer_parallel(fd, direct_fd, data, BYTES, offset, crc, [=](int piece_fd, size_t begin, size_t end){
+    return write_exact(piece_fd, data + begin, end - begin, offset + begin);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reads BYTES bytes from the file at offset into data with one
+///        pread stream per thread
+inline void read_parallel(int fd, int direct_fd, char* data, size_t BYTES, size_t offset){
+  transfer_parallel(fd, direct_fd, data, BYTES, offset, false, [=](int piece_fd, size_t begin, size_t end){
+    return read_exact(piece_fd, data + begin, end - begin, offset + begin);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Appends value to bytes in little endian order
+template<typename Value_type>
+void put_le(std::string& bytes, Value_type value){
+  for(size_t i = 0; i < sizeof(Value_type); ++i){
+    bytes += static_cast<char>((static_cast<uint64_t>(value) >> (8*i)) & 0xFF);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reads a little endian value from bytes
+template<typename Value_type>
+Value_type get_le(const char* bytes){
+  uint64_t value = 0;
+  for(size_t i = 0; i < sizeof(Value_type); ++i){
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8*i);
+  }
+  return static_cast<Value_type>(value);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Reads BYTES bytes of fd at offset into a string
+inline std::string read_string(int fd, size_t BYTES, size_t offset){
+  std::string bytes(BYTES, '\0');
+  const int error = read_exact(fd, bytes.data(), BYTES, offset);
+  if(error != 0){
+    throw std::runtime_error(std::string("cannot read the file: ") + std::strerror(error));
+  }
+  return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Calls f(task) for every task < N_TASKS on up to one thread per
+///        core, each thread taking the next task when it is done, and
+///        rethrows the first exception after all threads are joined
+template<typename Function_type>
+void run_parallel(size_t N_TASKS, Function_type f){
+  const size_t N_THREADS = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), N_TASKS);
+
+  std::atomic<size_t> next{0};
+  std::vector<std::exception_ptr> errors(N_THREADS);
+  std::vector<std::thread> threads;
+  threads.reserve(N_THREADS);
+  for(size_t t = 0; t < N_THREADS; ++t){
+    threads.emplace_back([&, t](){
+      try{
+        for(size_t task = next++; task < N_TASKS; task = next++){
+          f(task);
+        }
+      }
+      catch(...){
+        errors[t] = std::current_exception();
+        next = N_TASKS;
+      }
+    });
+  }
+  for(auto& thread : threads){
+    thread.join();
+  }
+  for(const auto& error : errors){
+    if(error){
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/// @}
+// end "Vector IO" doxygen group
+
+#endif //#ifndef VECTOR_IO_CPP
@@ -0,0 +1,208 @@
+#ifndef VECTOR_OPS_CPP
+#define VECTOR_OPS_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the operation codes used to describe chains of
+//         element-wise operations that are executed in a single kernel,
+//         from arithmetic with a scalar to unary math functions
+///////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Vector Ops
+/// \brief    Operation codes for batched element-wise operations
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Codes of the element-wise operations that can be chained in a
+///        batch, each code is paired with one scalar value x, which the
+///        unary math functions other than pow ignore
+enum Vector_Op : int {
+  VECTOR_OP_ADD      = 0,
+  VECTOR_OP_SUBTRACT = 1,
+  VECTOR_OP_MULTIPLY = 2,
+  VECTOR_OP_DIVIDE   = 3,
+  VECTOR_OP_EXP      = 4,
+  VECTOR_OP_LOG      = 5,
+  VECTOR_OP_SQRT     = 6,
+  VECTOR_OP_POW      = 7,
+  VECTOR_OP_SIN      = 8,
+  VECTOR_OP_COS      = 9,
+  VECTOR_OP_TANH     = 10,
+  VECTOR_OP_ERF      = 11,
+  VECTOR_OP_COUNT
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Flag added to the code of a math function to evaluate it with
+///        the fast single precision sycl::native builtins (or single
+///        precision builtins where there is no native one) instead of
+///        full double precision
+constexpr int VECTOR_OP_NATIVE = 0x100;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns true for the codes of the math functions, which accept
+///        VECTOR_OP_NATIVE
+inline bool is_vector_math_op(int op){
+  return op >= VECTOR_OP_EXP && op < VECTOR_OP_COUNT;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Applies a math function in single precision with the native
+///        builtins where sycl has them
+inline double apply_native_math_op(int op, double value, double x){
+  const float v = static_cast<float>(value);
+  switch(op){
+    case VECTOR_OP_EXP:  return sycl::native::exp(v);
+    case VECTOR_OP_LOG:  return sycl::native::log(v);
+    case VECTOR_OP_SQRT: return sycl::native::sqrt(v);
+    case VECTOR_OP_POW:  return sycl::pow(v, static_cast<float>(x));
+    case VECTOR_OP_SIN:  return sycl::native::sin(v);
+    case VECTOR_OP_COS:  return sycl::native::cos(v);
+    case VECTOR_OP_TANH: return sycl::tanh(v);
+    case VECTOR_OP_ERF:  return sycl::erf(v);
+    default:             return value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Applies the operation with code op and scalar x to a value,
+///        usable inside sycl kernels
+inline double apply_vector_op(int op, double value, double x){
+  switch(op){
+    case VECTOR_OP_ADD:      return value + x;
+    case VECTOR_OP_SUBTRACT: return value - x;
+    case VECTOR_OP_MULTIPLY: return value * x;
+    case VECTOR_OP_DIVIDE:   return value / x;
+    case VECTOR_OP_EXP:      return sycl::exp(value);
+    case VECTOR_OP_LOG:      return sycl::log(value);
+    case VECTOR_OP_SQRT:     return sycl::sqrt(value);
+    case VECTOR_OP_POW:      return sycl::pow(value, x);
+    case VECTOR_OP_SIN:      return sycl::sin(value);
+    case VECTOR_OP_COS:      return sycl::cos(value);
+    case VECTOR_OP_TANH:     return sycl::tanh(value);
+    case VECTOR_OP_ERF:      return sycl::erf(value);
+    default:
+      return (op & VECTOR_OP_NATIVE) ? apply_native_math_op(op & ~VECTOR_OP_NATIVE, value, x) : value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Checks that every op code is known
+inline void check_vector_op_codes(const std::vector<int>& op_codes){
+  for(int op : op_codes){
+    const int base = (op & VECTOR_OP_NATIVE) ? (op & ~VECTOR_OP_NATIVE) : op;
+    if(base < 0 || base >= VECTOR_OP_COUNT || (base != op && !is_vector_math_op(base))){
+      throw std::invalid_argument("unknown op code " + std::to_string(op));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Checks that every op code is known and that each code has a
+///        matching scalar
+inline void check_vector_ops(const std::vector<int>& op_codes,
+                             const std::vector<double>& x){
+  if(op_codes.size() != x.size()){
+    throw std::invalid_argument("number of op codes and scalars differ");
+  }
+  check_vector_op_codes(op_codes);
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the op code for a symbol or name such as "+", "add",
+///        "exp" or "native_exp"
+inline int vector_op_from_name(const std::string& name){
+  if(name == "+" || name == "add")                           return VECTOR_OP_ADD;
+  if(name == "-" || name == "sub" || name == "subtract")     return VECTOR_OP_SUBTRACT;
+  if(name == "*" || name == "mul" || name == "multiply")     return VECTOR_OP_MULTIPLY;
+  if(name == "/" || name == "div" || name == "divide")       return VECTOR_OP_DIVIDE;
+  if(name == "exp")                                          return VECTOR_OP_EXP;
+  if(name == "log")                                          return VECTOR_OP_LOG;
+  if(name == "sqrt")                                         return VECTOR_OP_SQRT;
+  if(name == "^" || name == "pow")                           return VECTOR_OP_POW;
+  if(name == "sin")                                          return VECTOR_OP_SIN;
+  if(name == "cos")                                          return VECTOR_OP_COS;
+  if(name == "tanh")                                         return VECTOR_OP_TANH;
+  if(name == "erf")                                          return VECTOR_OP_ERF;
+  if(name.rfind("native_", 0) == 0){
+    const int op = vector_op_from_name(name.substr(7));
+    if(is_vector_math_op(op)){
+      return op | VECTOR_OP_NATIVE;
+    }
+  }
+  throw std::invalid_argument("unknown op '" + name + "'");
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns true when the op reads its scalar x
+inline bool vector_op_takes_scalar(int op){
+  return !is_vector_math_op(op & ~VECTOR_OP_NATIVE) || (op & ~VECTOR_OP_NATIVE) == VECTOR_OP_POW;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Parses an op string such as "+2 *3.5 /4", "add 2; mul 3" or
+///        "*2 +1 log" into op codes and scalars, the math functions other
+///        than pow take no scalar and get x = 0
+inline void parse_vector_ops(const std::string& ops,
+                             std::vector<int>& op_codes,
+                             std::vector<double>& x){
+  op_codes.clear();
+  x.clear();
+
+  size_t pos = 0;
+  const auto skip_separators = [&](){
+    while(pos < ops.size() && (std::isspace(static_cast<unsigned char>(ops[pos]))
+                               || ops[pos] == ',' || ops[pos] == ';')){
+      ++pos;
+    }
+  };
+
+  skip_separators();
+  while(pos < ops.size()){
+    // reading the op symbol or name
+    std::string name;
+    if(std::isalpha(static_cast<unsigned char>(ops[pos]))){
+      while(pos < ops.size() && (std::isalpha(static_cast<unsigned char>(ops[pos])) || ops[pos] == '_')){
+        name += ops[pos++];
+      }
+    }
+    else{
+      name = ops[pos++];
+    }
+    op_codes.push_back(vector_op_from_name(name));
+
+    if(!vector_op_takes_scalar(op_codes.back())){
+      x.push_back(0.0);
+      skip_separators();
+      continue;
+    }
+
+    // reading the scalar that belongs to the op
+    while(pos < ops.size() && std::isspace(static_cast<unsigned char>(ops[pos]))){
+      ++pos;
+    }
+    const char* begin = ops.c_str() + pos;
+    char* end = nullptr;
+    const double value = std::strtod(begin, &end);
+    if(end == begin){
+      throw std::invalid_argument("missing scalar after op '" + name + "'");
+    }
+    x.push_back(value);
+    pos += end - begin;
+
+    skip_separators();
+  }
+}
+
+/// @}
+// end "Vector Ops" doxygen group
+
+#endif //#ifndef VECTOR_OPS_CPP
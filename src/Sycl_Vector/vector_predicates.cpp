@@ -0,0 +1,96 @@
+#ifndef VECTOR_PREDICATES_CPP
+#define VECTOR_PREDICATES_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the comparison predicates used by the
+//         filtering, validation and mask producing operations
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <stdexcept>
+
+// Sycl
+#include <CL/sycl.hpp>
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Vector Predicates
+/// \brief    Comparison predicates evaluated on each element
+/// @{
+///////////////////////////////////////////////////////////////////////////
+/// \brief Codes of the comparisons that a predicate can perform
+enum Vector_Compare : int {
+  VECTOR_COMPARE_LESS          = 0,
+  VECTOR_COMPARE_LESS_EQUAL    = 1,
+  VECTOR_COMPARE_GREATER       = 2,
+  VECTOR_COMPARE_GREATER_EQUAL = 3,
+  VECTOR_COMPARE_EQUAL         = 4,
+  VECTOR_COMPARE_NOT_EQUAL     = 5,
+  VECTOR_COMPARE_INSIDE        = 6,
+  VECTOR_COMPARE_OUTSIDE       = 7,
+  VECTOR_COMPARE_NAN           = 8,
+  VECTOR_COMPARE_INF           = 9,
+  VECTOR_COMPARE_FINITE        = 10
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief A comparison with up to two thresholds, trivially copyable so
+///        that it can be captured by sycl kernels
+struct Vector_Predicate{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Comparison code
+  int compare;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Threshold, or lower bound for "inside" and "outside"
+  double x;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Upper bound for "inside" and "outside"
+  double y;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Returns true when the value satisfies the predicate
+  bool operator()(double value) const{
+    switch(compare){
+      case VECTOR_COMPARE_LESS:          return value <  x;
+      case VECTOR_COMPARE_LESS_EQUAL:    return value <= x;
+      case VECTOR_COMPARE_GREATER:       return value >  x;
+      case VECTOR_COMPARE_GREATER_EQUAL: return value >= x;
+      case VECTOR_COMPARE_EQUAL:         return value == x;
+      case VECTOR_COMPARE_NOT_EQUAL:     return value != x;
+      case VECTOR_COMPARE_INSIDE:        return value >= x && value <= y;
+      case VECTOR_COMPARE_OUTSIDE:       return value <  x || value >  y;
+      case VECTOR_COMPARE_NAN:           return sycl::isnan(value);
+      case VECTOR_COMPARE_INF:           return sycl::isinf(value);
+      case VECTOR_COMPARE_FINITE:        return sycl::isfinite(value);
+      default:                           return false;
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Creates a predicate from a comparison name ("<", "<=", ">",
+///        ">=", "==", "!=", "inside", "outside", "nan", "inf", "finite")
+///        and its thresholds
+inline Vector_Predicate make_vector_predicate(const std::string& op, double x, double y){
+  int compare;
+  if(op == "<")             compare = VECTOR_COMPARE_LESS;
+  else if(op == "<=")       compare = VECTOR_COMPARE_LESS_EQUAL;
+  else if(op == ">")        compare = VECTOR_COMPARE_GREATER;
+  else if(op == ">=")       compare = VECTOR_COMPARE_GREATER_EQUAL;
+  else if(op == "==")       compare = VECTOR_COMPARE_EQUAL;
+  else if(op == "!=")       compare = VECTOR_COMPARE_NOT_EQUAL;
+  else if(op == "inside")   compare = VECTOR_COMPARE_INSIDE;
+  else if(op == "outside")  compare = VECTOR_COMPARE_OUTSIDE;
+  else if(op == "nan")      compare = VECTOR_COMPARE_NAN;
+  else if(op == "inf")      compare = VECTOR_COMPARE_INF;
+  else if(op == "finite")   compare = VECTOR_COMPARE_FINITE;
+  else throw std::invalid_argument("unknown comparison '" + op + "'");
+
+  return Vector_Predicate{compare, x, y};
+}
+
+/// @}
+// end "Vector Predicates" doxygen group
+
+#endif //#ifndef VECTOR_PREDICATES_CPP
@@ -0,0 +1,187 @@
+#ifndef VECTOR_STORAGE_CPP
+#define VECTOR_STORAGE_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the shared storage used by the vector classes,
+//         which can be allocated here, mapped from a file or adopted from
+//         a NumPy array
+///////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <new>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+// Anonymous and file mappings
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Pybind11
+#include <pybind11/numpy.h>
+
+namespace py = pybind11;
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Vector Storage
+/// \brief    Shared storage for the sycl based vectors
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Allocations of at least this many bytes are mapped directly and
+///        first touched in parallel
+constexpr size_t STORAGE_PARALLEL_BYTES = size_t(1) << 22;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Size of a transparent huge page
+constexpr size_t STORAGE_HUGE_PAGE_BYTES = size_t(1) << 21;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Zeroes BYTES bytes at data, or copies them from source when
+///        given, with one thread per contiguous, page aligned chunk
+///
+/// Linux places a page on the NUMA node of the thread that first writes
+/// it, so the pages spread over the nodes the threads run on instead of
+/// all landing on the constructing thread's node. data must be aligned
+/// to PAGE_BYTES for every page to be touched by a single thread.
+inline void first_touch_parallel(void* data, size_t BYTES, size_t PAGE_BYTES, const void* source = nullptr){
+  const size_t N_PAGES   = (BYTES + PAGE_BYTES - 1)/PAGE_BYTES;
+  const size_t N_THREADS = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), N_PAGES));
+  const size_t CHUNK     = (N_PAGES + N_THREADS - 1)/N_THREADS*PAGE_BYTES;
+
+  std::vector<std::thread> threads;
+  threads.reserve(N_THREADS);
+  for(size_t t = 0; t < N_THREADS; ++t){
+    const size_t begin = std::min(t*CHUNK, BYTES);
+    const size_t end   = std::min(begin + CHUNK, BYTES);
+    threads.emplace_back([=](){
+      if(source != nullptr){
+        std::memcpy(static_cast<char*>(data) + begin, static_cast<const char*>(source) + begin, end - begin);
+      }
+      else{
+        std::memset(static_cast<char*>(data) + begin, 0, end - begin);
+      }
+    });
+  }
+  for(auto& thread : threads){
+    thread.join();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Allocates storage for SIZE elements, zero initialized or copied
+///        from source when given
+///
+/// Small allocations use new[]. Large ones are mapped in one shot and
+/// first touched in parallel, optionally backed by transparent huge pages
+/// to cut TLB misses on streaming kernels.
+template<typename Value_type>
+std::shared_ptr<Value_type> allocate_storage(size_t SIZE, bool huge_pages = false,
+                                             const Value_type* source = nullptr){
+  static_assert(std::is_trivially_copyable_v<Value_type>, "storage holds plain values");
+
+  const size_t BYTES = SIZE*sizeof(Value_type);
+  if(BYTES < STORAGE_PARALLEL_BYTES){
+    std::shared_ptr<Value_type> storage(new Value_type[SIZE](), std::default_delete<Value_type[]>());
+    if(source != nullptr){
+      std::copy(source, source + SIZE, storage.get());
+    }
+    return storage;
+  }
+
+  // rounding up to whole huge pages so that the tail can be backed too
+  const size_t MAPPED_BYTES = huge_pages
+    ? (BYTES + STORAGE_HUGE_PAGE_BYTES - 1)/STORAGE_HUGE_PAGE_BYTES*STORAGE_HUGE_PAGE_BYTES
+    : BYTES;
+
+  // mmap only aligns to the base page, so huge page mappings are over
+  // mapped by one huge page and the slack around the aligned range is
+  // unmapped again
+  const size_t SLACK_BYTES = huge_pages ? STORAGE_HUGE_PAGE_BYTES : 0;
+  void* base = mmap(nullptr, MAPPED_BYTES + SLACK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(base == MAP_FAILED){
+    throw std::bad_alloc();
+  }
+  void* data = base;
+  if(huge_pages){
+    const uintptr_t BASE    = reinterpret_cast<uintptr_t>(base);
+    const uintptr_t ALIGNED = (BASE + STORAGE_HUGE_PAGE_BYTES - 1)/STORAGE_HUGE_PAGE_BYTES*STORAGE_HUGE_PAGE_BYTES;
+    const size_t HEAD_BYTES = ALIGNED - BASE;
+    if(HEAD_BYTES > 0){
+      munmap(base, HEAD_BYTES);
+    }
+    if(SLACK_BYTES > HEAD_BYTES){
+      munmap(reinterpret_cast<void*>(ALIGNED + MAPPED_BYTES), SLACK_BYTES - HEAD_BYTES);
+    }
+    data = reinterpret_cast<void*>(ALIGNED);
+  }
+
+  size_t page_bytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#ifdef MADV_HUGEPAGE
+  if(huge_pages && madvise(data, MAPPED_BYTES, MADV_HUGEPAGE) == 0){
+    page_bytes = STORAGE_HUGE_PAGE_BYTES;
+  }
+#endif
+
+  first_touch_parallel(data, BYTES, page_bytes, source);
+
+  return std::shared_ptr<Value_type>(static_cast<Value_type*>(data), [MAPPED_BYTES](Value_type* p){
+    munmap(p, MAPPED_BYTES);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Maps SIZE elements of the file fd starting at byte offset as
+///        copy-on-write storage, so the pages are read on first access
+///        and changes never reach the file
+template<typename Value_type>
+std::shared_ptr<Value_type> map_file_storage(int fd, size_t offset, size_t SIZE){
+  // mappings start on a page boundary
+  const size_t PAGE_BYTES   = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t MAP_OFFSET   = offset/PAGE_BYTES*PAGE_BYTES;
+  const size_t MAPPED_BYTES = offset - MAP_OFFSET + SIZE*sizeof(Value_type);
+  void* data = mmap(nullptr, MAPPED_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(MAP_OFFSET));
+  if(data == MAP_FAILED){
+    throw std::bad_alloc();
+  }
+
+  char* first = static_cast<char*>(data) + (offset - MAP_OFFSET);
+  return std::shared_ptr<Value_type>(reinterpret_cast<Value_type*>(first), [data, MAPPED_BYTES](Value_type*){
+    munmap(data, MAPPED_BYTES);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Adopts the memory of a NumPy array without copying, the array
+///        stays alive for as long as the storage is in use
+template<typename Value_type>
+std::shared_ptr<Value_type> adopt_storage(py::array_t<Value_type, py::array::c_style> array){
+  auto* owner = new py::object(array);
+  return std::shared_ptr<Value_type>(array.mutable_data(), [owner](Value_type*){
+    py::gil_scoped_acquire gil;
+    delete owner;
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns a NumPy array that views the storage without copying,
+///        the storage stays alive for as long as the array is in use
+template<typename Value_type>
+py::array_t<Value_type> share_storage(const std::shared_ptr<Value_type>& storage, size_t SIZE){
+  auto* owner = new std::shared_ptr<Value_type>(storage);
+  py::capsule base(owner, [](void* p){
+    delete static_cast<std::shared_ptr<Value_type>*>(p);
+  });
+  return py::array_t<Value_type>(std::vector<py::ssize_t>{static_cast<py::ssize_t>(SIZE)},
+                                 std::vector<py::ssize_t>{sizeof(Value_type)},
+                                 storage.get(), base);
+}
+
+/// @}
+// end "Vector Storage" doxygen group
+
+#endif //#ifndef VECTOR_STORAGE_CPP
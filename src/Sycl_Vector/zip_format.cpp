@@ -0,0 +1,246 @@
+#ifndef ZIP_FORMAT_CPP
+#define ZIP_FORMAT_CPP
+////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Header containing the parts of the zip format used by NumPy
+//         .npz archives, limited to stored (uncompressed) members
+///////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+// File I/O
+#include "vector_io.cpp"
+
+///////////////////////////////////////////////////////////////////////////
+/// \defgroup Zip Format
+/// \brief    Single member zip64 writing and stored member lookup
+/// @{
+///////////////////////////////////////////////////////////////////////////
+
+constexpr uint32_t ZIP_LOCAL_SIGNATURE        = 0x04034B50;
+constexpr uint32_t ZIP_CENTRAL_SIGNATURE      = 0x02014B50;
+constexpr uint32_t ZIP_END_SIGNATURE          = 0x06054B50;
+constexpr uint32_t ZIP64_END_SIGNATURE        = 0x06064B50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE    = 0x07064B50;
+constexpr uint16_t ZIP64_EXTRA_ID             = 0x0001;
+constexpr uint16_t ZIP_ALIGNMENT_EXTRA_ID     = 0xD935;
+constexpr uint16_t ZIP64_VERSION              = 45;
+constexpr uint16_t ZIP_STORED                 = 0;
+constexpr uint16_t ZIP_DOS_DATE               = 0x21; // 1980-01-01
+constexpr size_t   ZIP_LOCAL_HEADER_BYTES     = 30;
+constexpr size_t   ZIP_CENTRAL_HEADER_BYTES   = 46;
+constexpr size_t   ZIP_END_BYTES              = 22;
+constexpr size_t   ZIP64_END_BYTES            = 56;
+constexpr size_t   ZIP64_LOCATOR_BYTES        = 20;
+constexpr size_t   ZIP_MAX_COMMENT_BYTES      = 0xFFFF;
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Location of a member of a zip archive
+struct Zip_Member{
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Name of the member
+  std::string name;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Compression method, ZIP_STORED for uncompressed data
+  uint16_t method;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Number of bytes of the member data as stored in the archive
+  uint64_t size;
+
+  ////////////////////////////////////////////////////////////////////////
+  /// \brief Offset of the member data in the archive
+  uint64_t data_offset;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the zip64 local header of a stored member of SIZE bytes,
+///        padded with an alignment record so that the member data starts
+///        at a multiple of ALIGNMENT bytes, the length does not depend on
+///        SIZE or crc so the data can be written before the header
+inline std::string zip_local_header(const std::string& name, uint64_t SIZE, uint32_t crc, size_t ALIGNMENT){
+  const size_t FIXED_BYTES = ZIP_LOCAL_HEADER_BYTES + name.size() + 4 + 16 + 4;
+  const size_t PADDING     = (FIXED_BYTES + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT - FIXED_BYTES;
+
+  std::string header;
+  put_le<uint32_t>(header, ZIP_LOCAL_SIGNATURE);
+  put_le<uint16_t>(header, ZIP64_VERSION);
+  put_le<uint16_t>(header, 0);
+  put_le<uint16_t>(header, ZIP_STORED);
+  put_le<uint16_t>(header, 0);
+  put_le<uint16_t>(header, ZIP_DOS_DATE);
+  put_le<uint32_t>(header, crc);
+  // the sizes live in the zip64 record
+  put_le<uint32_t>(header, 0xFFFFFFFF);
+  put_le<uint32_t>(header, 0xFFFFFFFF);
+  put_le<uint16_t>(header, name.size());
+  put_le<uint16_t>(header, 4 + 16 + 4 + PADDING);
+  header += name;
+
+  put_le<uint16_t>(header, ZIP64_EXTRA_ID);
+  put_le<uint16_t>(header, 16);
+  put_le<uint64_t>(header, SIZE);
+  put_le<uint64_t>(header, SIZE);
+
+  put_le<uint16_t>(header, ZIP_ALIGNMENT_EXTRA_ID);
+  put_le<uint16_t>(header, PADDING);
+  header.append(PADDING, '\0');
+  return header;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the central directory and end records of an archive
+///        holding one stored member of SIZE bytes whose local header is at
+///        offset 0, with the central directory at CENTRAL_OFFSET
+inline std::string zip_central_directory(const std::string& name, uint64_t SIZE, uint32_t crc,
+                                         uint64_t CENTRAL_OFFSET){
+  std::string bytes;
+  put_le<uint32_t>(bytes, ZIP_CENTRAL_SIGNATURE);
+  put_le<uint16_t>(bytes, ZIP64_VERSION);
+  put_le<uint16_t>(bytes, ZIP64_VERSION);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, ZIP_STORED);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, ZIP_DOS_DATE);
+  put_le<uint32_t>(bytes, crc);
+  put_le<uint32_t>(bytes, 0xFFFFFFFF);
+  put_le<uint32_t>(bytes, 0xFFFFFFFF);
+  put_le<uint16_t>(bytes, name.size());
+  put_le<uint16_t>(bytes, 4 + 24);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint32_t>(bytes, 0);
+  put_le<uint32_t>(bytes, 0xFFFFFFFF);
+  bytes += name;
+  put_le<uint16_t>(bytes, ZIP64_EXTRA_ID);
+  put_le<uint16_t>(bytes, 24);
+  put_le<uint64_t>(bytes, SIZE);
+  put_le<uint64_t>(bytes, SIZE);
+  put_le<uint64_t>(bytes, 0);
+
+  const uint64_t CENTRAL_BYTES = bytes.size();
+  const uint64_t ZIP64_END_OFFSET = CENTRAL_OFFSET + CENTRAL_BYTES;
+
+  put_le<uint32_t>(bytes, ZIP64_END_SIGNATURE);
+  put_le<uint64_t>(bytes, ZIP64_END_BYTES - 12);
+  put_le<uint16_t>(bytes, ZIP64_VERSION);
+  put_le<uint16_t>(bytes, ZIP64_VERSION);
+  put_le<uint32_t>(bytes, 0);
+  put_le<uint32_t>(bytes, 0);
+  put_le<uint64_t>(bytes, 1);
+  put_le<uint64_t>(bytes, 1);
+  put_le<uint64_t>(bytes, CENTRAL_BYTES);
+  put_le<uint64_t>(bytes, CENTRAL_OFFSET);
+
+  put_le<uint32_t>(bytes, ZIP64_LOCATOR_SIGNATURE);
+  put_le<uint32_t>(bytes, 0);
+  put_le<uint64_t>(bytes, ZIP64_END_OFFSET);
+  put_le<uint32_t>(bytes, 1);
+
+  put_le<uint32_t>(bytes, ZIP_END_SIGNATURE);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, 0);
+  put_le<uint16_t>(bytes, 0xFFFF);
+  put_le<uint16_t>(bytes, 0xFFFF);
+  put_le<uint32_t>(bytes, 0xFFFFFFFF);
+  put_le<uint32_t>(bytes, 0xFFFFFFFF);
+  put_le<uint16_t>(bytes, 0);
+  return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+/// \brief Returns the member called name of the zip archive fd of
+///        FILE_BYTES bytes, the first member when name is empty
+inline Zip_Member find_zip_member(int fd, size_t FILE_BYTES, const std::string& name){
+  // the end record sits before a comment of at most 64 KiB
+  const size_t TAIL_BYTES = std::min(FILE_BYTES, ZIP_END_BYTES + ZIP_MAX_COMMENT_BYTES);
+  const std::string tail  = read_string(fd, TAIL_BYTES, FILE_BYTES - TAIL_BYTES);
+  size_t end = std::string::npos;
+  for(size_t pos = TAIL_BYTES >= ZIP_END_BYTES ? TAIL_BYTES - ZIP_END_BYTES + 1 : 0; pos-- > 0;){
+    if(get_le<uint32_t>(tail.data() + pos) == ZIP_END_SIGNATURE){
+      end = pos;
+      break;
+    }
+  }
+  if(end == std::string::npos){
+    throw std::invalid_argument("not a zip archive");
+  }
+
+  uint64_t N_ENTRIES      = get_le<uint16_t>(tail.data() + end + 10);
+  uint64_t CENTRAL_OFFSET = get_le<uint32_t>(tail.data() + end + 16);
+  if(end >= ZIP64_LOCATOR_BYTES
+     && get_le<uint32_t>(tail.data() + end - ZIP64_LOCATOR_BYTES) == ZIP64_LOCATOR_SIGNATURE){
+    const uint64_t ZIP64_END_OFFSET = get_le<uint64_t>(tail.data() + end - ZIP64_LOCATOR_BYTES + 8);
+    const std::string zip64_end = read_string(fd, ZIP64_END_BYTES, ZIP64_END_OFFSET);
+    if(get_le<uint32_t>(zip64_end.data()) != ZIP64_END_SIGNATURE){
+      throw std::invalid_argument("corrupt zip64 end record");
+    }
+    N_ENTRIES      = get_le<uint64_t>(zip64_end.data() + 32);
+    CENTRAL_OFFSET = get_le<uint64_t>(zip64_end.data() + 48);
+  }
+
+  uint64_t offset = CENTRAL_OFFSET;
+  for(uint64_t entry = 0; entry < N_ENTRIES; ++entry){
+    const std::string header = read_string(fd, ZIP_CENTRAL_HEADER_BYTES, offset);
+    if(get_le<uint32_t>(header.data()) != ZIP_CENTRAL_SIGNATURE){
+      throw std::invalid_argument("corrupt zip central directory");
+    }
+    const uint16_t NAME_BYTES    = get_le<uint16_t>(header.data() + 28);
+    const uint16_t EXTRA_BYTES   = get_le<uint16_t>(header.data() + 30);
+    const uint16_t COMMENT_BYTES = get_le<uint16_t>(header.data() + 32);
+    const std::string rest = read_string(fd, NAME_BYTES + EXTRA_BYTES, offset + ZIP_CENTRAL_HEADER_BYTES);
+    offset += ZIP_CENTRAL_HEADER_BYTES + NAME_BYTES + EXTRA_BYTES + COMMENT_BYTES;
+
+    Zip_Member member;
+    member.name   = rest.substr(0, NAME_BYTES);
+    member.method = get_le<uint16_t>(header.data() + 10);
+    if(!name.empty() && member.name != name && member.name != name + ".npy"){
+      continue;
+    }
+
+    // the zip64 record holds, in order, the fields that are saturated
+    uint64_t uncompressed = get_le<uint32_t>(header.data() + 24);
+    uint64_t compressed   = get_le<uint32_t>(header.data() + 20);
+    uint64_t local_offset = get_le<uint32_t>(header.data() + 42);
+    for(size_t pos = NAME_BYTES; pos + 4 <= rest.size();){
+      const uint16_t id    = get_le<uint16_t>(rest.data() + pos);
+      const uint16_t BYTES = get_le<uint16_t>(rest.data() + pos + 2);
+      if(id == ZIP64_EXTRA_ID){
+        size_t field = pos + 4;
+        for(uint64_t* value : {&uncompressed, &compressed, &local_offset}){
+          if(*value == 0xFFFFFFFF && field + 8 <= pos + 4 + BYTES){
+            *value = get_le<uint64_t>(rest.data() + field);
+            field += 8;
+          }
+        }
+      }
+      pos += 4 + BYTES;
+    }
+
+    const std::string local = read_string(fd, ZIP_LOCAL_HEADER_BYTES, local_offset);
+    if(get_le<uint32_t>(local.data()) != ZIP_LOCAL_SIGNATURE){
+      throw std::invalid_argument("corrupt zip local header");
+    }
+    member.size        = member.method == ZIP_STORED ? uncompressed : compressed;
+    member.data_offset = local_offset + ZIP_LOCAL_HEADER_BYTES
+                       + get_le<uint16_t>(local.data() + 26) + get_le<uint16_t>(local.data() + 28);
+    if(member.data_offset + member.size > FILE_BYTES){
+      throw std::invalid_argument("zip member " + member.name + " runs past the end of the archive");
+    }
+    return member;
+  }
+
+  throw std::invalid_argument(name.empty() ? std::string("the archive is empty")
+                                           : "the archive has no member " + name);
+}
+
+/// @}
+// end "Zip Format" doxygen group
+
+#endif //#ifndef ZIP_FORMAT_CPP